@@ -1,6 +1,14 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import uart, sensor, switch, select, number, climate
+from esphome.components import (
+    uart,
+    sensor,
+    binary_sensor,
+    switch,
+    select,
+    number,
+    climate,
+)
 from esphome.const import (
     CONF_ID,
     DEVICE_CLASS_TEMPERATURE,
@@ -11,23 +19,34 @@ from esphome.const import (
     DEVICE_CLASS_HUMIDITY,
     DEVICE_CLASS_VOLTAGE,
     DEVICE_CLASS_CURRENT,
+    DEVICE_CLASS_CONNECTIVITY,
+    ENTITY_CATEGORY_DIAGNOSTIC,
     UNIT_CELSIUS,
     UNIT_PERCENT,
     UNIT_WATT,
     UNIT_VOLT,
     UNIT_AMPERE,
+    UNIT_MILLISECOND,
     CONF_UNIT_OF_MEASUREMENT,
     CONF_DEVICE_CLASS,
     CONF_FILTERS,
     CONF_FLOW_CONTROL_PIN,
 )
-from esphome.core import CORE, Lambda
+from esphome.core import CORE
 from esphome.cpp_helpers import gpio_pin_expression
-from esphome import pins
+from esphome import pins, automation
 
 CODEOWNERS = ["matthias882", "lanwin", "omerfaruk-aran"]
 DEPENDENCIES = ["uart"]
-AUTO_LOAD = ["sensor", "switch", "select", "number", "climate"]
+AUTO_LOAD = [
+    "sensor",
+    "binary_sensor",
+    "switch",
+    "select",
+    "number",
+    "climate",
+    "socket",
+]
 MULTI_CONF = False
 
 CONF_SAMSUNG_AC_ID = "samsung_ac_id"
@@ -42,6 +61,10 @@ Samsung_AC_Water_Heater_Mode_Select = samsung_ac.class_(
 )
 Samsung_AC_Number = samsung_ac.class_("Samsung_AC_Number", number.Number)
 Samsung_AC_Climate = samsung_ac.class_("Samsung_AC_Climate", climate.Climate)
+ValueType = samsung_ac.enum("ValueType", is_class=True)
+Mode = samsung_ac.enum("Mode", is_class=True)
+FanMode = samsung_ac.enum("FanMode", is_class=True)
+ControlGroupAction = samsung_ac.class_("ControlGroupAction", automation.Action)
 
 # not sure why select.select_schema did not work yet
 SELECT_MODE_SCHEMA = select.select_schema(Samsung_AC_Mode_Select)
@@ -49,11 +72,21 @@ SELECT_WATER_HEATER_MODE_SCHEMA = select.select_schema(
     Samsung_AC_Water_Heater_Mode_Select
 )
 
-NUMBER_SCHEMA = number.number_schema(Samsung_AC_Number).extend(
-    {cv.GenerateID(): cv.declare_id(Samsung_AC_Number)}
+CONF_DEBOUNCE = "debounce"
+
+# changes are sent once they did not change for this long, e.g. while a slider is dragged.
+# the climate only debounces its target temperature.
+DEBOUNCE_SCHEMA = {
+    cv.Optional(CONF_DEBOUNCE, default="500ms"): cv.positive_time_period_milliseconds
+}
+
+NUMBER_SCHEMA = (
+    number.number_schema(Samsung_AC_Number)
+    .extend({cv.GenerateID(): cv.declare_id(Samsung_AC_Number)})
+    .extend(DEBOUNCE_SCHEMA)
 )
 
-CLIMATE_SCHEMA = climate.climate_schema(Samsung_AC_Climate)
+CLIMATE_SCHEMA = climate.climate_schema(Samsung_AC_Climate).extend(DEBOUNCE_SCHEMA)
 
 CONF_DEVICE_ID = "samsung_ac_device_id"
 CONF_DEVICE_ADDRESS = "address"
@@ -76,11 +109,18 @@ CONF_DEVICE_ROOM_HUMIDITY = "room_humidity"
 CONF_DEVICE_CUSTOM = "custom_sensor"
 CONF_DEVICE_CUSTOM_MESSAGE = "message"
 CONF_DEVICE_CUSTOM_RAW_FILTERS = "raw_filters"
+CONF_DEVICE_CUSTOM_VALUE_TYPE = "value_type"
+CONF_DEVICE_CUSTOM_MULTIPLY = "multiply"
+CONF_DEVICE_CUSTOM_OFFSET = "offset"
 CONF_DEVICE_ERROR_CODE = "error_code"
+CONF_DEVICE_AVAILABILITY = "availability"
+CONF_DEVICE_COMMAND_LATENCY = "command_latency"
 CONF_DEVICE_OUT_CONTROL_WATTMETER_ALL_UNIT_ACCUM = "outdoor_instantaneous_power"
 CONF_DEVICE_OUT_CONTROL_WATTMETER_1W_1MIN_SUM = "outdoor_cumulative_energy"
 CONF_DEVICE_OUT_SENSOR_CT1 = "outdoor_current"
 CONF_DEVICE_OUT_SENSOR_VOLTAGE = "outdoor_voltage"
+CONF_DEVICE_POLL = "poll"
+CONF_DEVICE_POLL_INTERVAL = "interval"
 
 
 CONF_CAPABILITIES = "capabilities"
@@ -135,12 +175,43 @@ CAPABILITIES_SCHEMA = cv.Schema(
     }
 )
 
-CUSTOM_SENSOR_SCHEMA = sensor.sensor_schema().extend(
+POLL_SCHEMA = cv.Schema(
     {
         cv.Required(CONF_DEVICE_CUSTOM_MESSAGE): cv.hex_int,
+        cv.Optional(
+            CONF_DEVICE_POLL_INTERVAL, default="60s"
+        ): cv.positive_time_period_milliseconds,
     }
 )
 
+VALUE_TYPES = {
+    "unsigned": ValueType.Unsigned,
+    "signed16": ValueType.Signed16,
+    "signed32": ValueType.Signed32,
+}
+
+
+# conversion of the raw message value, applied before any filters
+def value_converter_schema(value_type="unsigned", multiply=1.0, offset=0.0):
+    return {
+        cv.Optional(CONF_DEVICE_CUSTOM_VALUE_TYPE, default=value_type): cv.enum(
+            VALUE_TYPES, lower=True
+        ),
+        cv.Optional(CONF_DEVICE_CUSTOM_MULTIPLY, default=multiply): cv.float_,
+        cv.Optional(CONF_DEVICE_CUSTOM_OFFSET, default=offset): cv.float_,
+    }
+
+
+CUSTOM_SENSOR_SCHEMA = (
+    sensor.sensor_schema()
+    .extend(
+        {
+            cv.Required(CONF_DEVICE_CUSTOM_MESSAGE): cv.hex_int,
+        }
+    )
+    .extend(value_converter_schema())
+)
+
 
 def custom_sensor_schema(
     message: int,
@@ -150,7 +221,9 @@ def custom_sensor_schema(
     device_class=cv.UNDEFINED,
     state_class=cv.UNDEFINED,
     entity_category=cv.UNDEFINED,
-    raw_filters=[],
+    value_type="unsigned",
+    multiply=1.0,
+    offset=0.0,
 ):
     schema = sensor.sensor_schema(
         unit_of_measurement=unit_of_measurement,
@@ -161,8 +234,9 @@ def custom_sensor_schema(
         entity_category=entity_category
     ).extend({
         cv.Optional(CONF_DEVICE_CUSTOM_MESSAGE, default=message): cv.hex_int,
-        cv.Optional(CONF_DEVICE_CUSTOM_RAW_FILTERS, default=raw_filters): sensor.validate_filters,
-    })
+        # filters which get the raw message value, the conversion is skipped when set
+        cv.Optional(CONF_DEVICE_CUSTOM_RAW_FILTERS, default=[]): sensor.validate_filters,
+    }).extend(value_converter_schema(value_type, multiply, offset))
 
     return schema
 
@@ -174,7 +248,8 @@ def temperature_sensor_schema(message: int):
         accuracy_decimals=1,
         device_class=DEVICE_CLASS_TEMPERATURE,
         state_class=STATE_CLASS_MEASUREMENT,
-        raw_filters=[{"lambda": Lambda("return (int16_t)x;")}, {"multiply": 0.1}],
+        value_type="signed16",
+        multiply=0.1,
     )
 
 
@@ -229,6 +304,18 @@ DEVICE_SCHEMA = cv.Schema(
             state_class=STATE_CLASS_MEASUREMENT,
         ),
         cv.Optional(CONF_DEVICE_ERROR_CODE): error_code_sensor_schema(0x8235),
+        # online while the unit sends frames, offline when it went quiet
+        cv.Optional(CONF_DEVICE_AVAILABILITY): binary_sensor.binary_sensor_schema(
+            device_class=DEVICE_CLASS_CONNECTIVITY,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        # time until the unit reported a value which was changed from here
+        cv.Optional(CONF_DEVICE_COMMAND_LATENCY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            icon="mdi:timer-outline",
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
         cv.Optional(CONF_DEVICE_TARGET_TEMPERATURE): NUMBER_SCHEMA,
         cv.Optional(CONF_DEVICE_WATER_OUTLET_TARGET): NUMBER_SCHEMA,
         cv.Optional(CONF_DEVICE_WATER_TARGET_TEMPERATURE): NUMBER_SCHEMA,
@@ -245,6 +332,8 @@ DEVICE_SCHEMA = cv.Schema(
         cv.Optional(CONF_DEVICE_CUSTOM, default=[]): cv.ensure_list(
             CUSTOM_SENSOR_SCHEMA
         ),
+        # messages which are not broadcast by the device and have to be read actively (NASA only)
+        cv.Optional(CONF_DEVICE_POLL, default=[]): cv.ensure_list(POLL_SCHEMA),
         # keep CUSTOM_SENSOR_KEYS in sync with these
         cv.Optional(CONF_DEVICE_WATER_TEMPERATURE): temperature_sensor_schema(0x4237),
         cv.Optional(CONF_DEVICE_ROOM_HUMIDITY): humidity_sensor_schema(0x4038),
@@ -317,6 +406,20 @@ CONF_DEBUG_LOG_MESSAGES_RAW = "debug_log_messages_raw"
 
 CONF_NON_NASA_KEEPALIVE = "non_nasa_keepalive"
 
+CONF_NASA_POLL_BUS_UTILISATION = "nasa_poll_bus_utilisation"
+
+CONF_SYNC_TIME = "sync_time"
+
+CONF_RESTORE_STATE = "restore_state"
+
+CONF_PASSIVE = "passive"
+
+CONF_DEVICE_TIMEOUT = "device_timeout"
+
+CONF_RAW_STREAM_PORT = "raw_stream_port"
+
+CONF_RX_TASK = "rx_task"
+
 CONF_DEBUG_LOG_UNDEFINED_MESSAGES = "debug_log_undefined_messages"
 
 
@@ -333,7 +436,28 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_DEBUG_LOG_MESSAGES, default=False): cv.boolean,
             cv.Optional(CONF_DEBUG_LOG_MESSAGES_RAW, default=False): cv.boolean,
             cv.Optional(CONF_NON_NASA_KEEPALIVE, default=False): cv.boolean,
+            cv.Optional(CONF_RESTORE_STATE, default=True): cv.boolean,
+            # listen only, never write to the bus
+            cv.Optional(CONF_PASSIVE, default=False): cv.boolean,
+            # units which send nothing for this long are offline, their values become unknown
+            cv.Optional(
+                CONF_DEVICE_TIMEOUT, default="2min"
+            ): cv.positive_time_period_milliseconds,
+            # streams all raw frames to a TCP client, see test/main_raw_stream_receiver.cpp
+            cv.Optional(CONF_RAW_STREAM_PORT): cv.port,
+            # drain and frame the UART on a separate task (ESP32), so a busy main loop loses no frames
+            cv.Optional(CONF_RX_TASK, default=False): cv.boolean,
+            cv.Optional(
+                CONF_NASA_POLL_BUS_UTILISATION, default="10%"
+            ): cv.percentage,
             cv.Optional(CONF_DEBUG_LOG_UNDEFINED_MESSAGES, default=False): cv.boolean,
+            # time from boot until all configured values were received once, again after a unit came back online
+            cv.Optional(CONF_SYNC_TIME): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                icon="mdi:timer-sand",
+                entity_category="diagnostic",
+            ),
             cv.Optional(CONF_CAPABILITIES): CAPABILITIES_SCHEMA,
             cv.Required(CONF_DEVICES): cv.ensure_list(DEVICE_SCHEMA),
         }
@@ -446,6 +570,14 @@ async def to_code(config):
                 var_dev.set_indoor_eva_out_temperature_sensor,
             ),
             CONF_DEVICE_ERROR_CODE: (sensor.new_sensor, var_dev.set_error_code_sensor),
+            CONF_DEVICE_AVAILABILITY: (
+                binary_sensor.new_binary_sensor,
+                var_dev.set_availability_sensor,
+            ),
+            CONF_DEVICE_COMMAND_LATENCY: (
+                sensor.new_sensor,
+                var_dev.set_command_latency_sensor,
+            ),
             CONF_DEVICE_OUT_CONTROL_WATTMETER_ALL_UNIT_ACCUM: (
                 sensor.new_sensor,
                 var_dev.set_outdoor_instantaneous_power_sensor,
@@ -485,6 +617,7 @@ async def to_code(config):
             num = await number.new_number(
                 conf, min_value=30.0, max_value=70.0, step=0.5
             )
+            cg.add(num.set_debounce(conf[CONF_DEBOUNCE]))
             cg.add(var_dev.set_target_water_temperature_number(num))
 
         if CONF_DEVICE_TARGET_TEMPERATURE in device:
@@ -494,6 +627,7 @@ async def to_code(config):
             num = await number.new_number(
                 conf, min_value=16.0, max_value=30.0, step=1.0
             )
+            cg.add(num.set_debounce(conf[CONF_DEBOUNCE]))
             cg.add(var_dev.set_target_temperature_number(num))
 
         if CONF_DEVICE_WATER_OUTLET_TARGET in device:
@@ -503,6 +637,7 @@ async def to_code(config):
             num = await number.new_number(
                 conf, min_value=15.0, max_value=55.0, step=0.1
             )
+            cg.add(num.set_debounce(conf[CONF_DEBOUNCE]))
             cg.add(var_dev.set_water_outlet_target_number(num))
 
         if CONF_DEVICE_MODE in device:
@@ -521,6 +656,7 @@ async def to_code(config):
             conf = device[CONF_DEVICE_CLIMATE]
             var_cli = cg.new_Pvariable(conf[CONF_ID])
             await climate.register_climate(var_cli, conf)
+            cg.add(var_cli.set_debounce(conf[CONF_DEBOUNCE]))
             cg.add(var_dev.set_climate(var_cli))
 
         if CONF_DEVICE_CUSTOM in device:
@@ -528,7 +664,11 @@ async def to_code(config):
                 sens = await sensor.new_sensor(cust_sens)
                 cg.add(
                     var_dev.add_custom_sensor(
-                        cust_sens[CONF_DEVICE_CUSTOM_MESSAGE], sens
+                        cust_sens[CONF_DEVICE_CUSTOM_MESSAGE],
+                        sens,
+                        cust_sens[CONF_DEVICE_CUSTOM_VALUE_TYPE],
+                        cust_sens[CONF_DEVICE_CUSTOM_MULTIPLY],
+                        cust_sens[CONF_DEVICE_CUSTOM_OFFSET],
                     )
                 )
 
@@ -543,9 +683,27 @@ async def to_code(config):
                     else []
                 ) + (conf[CONF_FILTERS] if CONF_FILTERS in conf else [])
                 sens = await sensor.new_sensor(conf_copy)
-                cg.add(
-                    var_dev.add_custom_sensor(conf[CONF_DEVICE_CUSTOM_MESSAGE], sens)
+                if conf[CONF_DEVICE_CUSTOM_RAW_FILTERS]:
+                    cg.add(
+                        var_dev.add_custom_sensor(conf[CONF_DEVICE_CUSTOM_MESSAGE], sens)
+                    )
+                else:
+                    cg.add(
+                        var_dev.add_custom_sensor(
+                            conf[CONF_DEVICE_CUSTOM_MESSAGE],
+                            sens,
+                            conf[CONF_DEVICE_CUSTOM_VALUE_TYPE],
+                            conf[CONF_DEVICE_CUSTOM_MULTIPLY],
+                            conf[CONF_DEVICE_CUSTOM_OFFSET],
+                        )
+                    )
+
+        for poll in device[CONF_DEVICE_POLL]:
+            cg.add(
+                var_dev.add_poll_message(
+                    poll[CONF_DEVICE_CUSTOM_MESSAGE], poll[CONF_DEVICE_POLL_INTERVAL]
                 )
+            )
 
         cg.add(var.register_device(var_dev))
 
@@ -574,6 +732,21 @@ async def to_code(config):
             )
         )
 
+    cg.add(var.set_restore_state(config[CONF_RESTORE_STATE]))
+    cg.add(var.set_passive(config[CONF_PASSIVE]))
+    cg.add(var.set_device_timeout(config[CONF_DEVICE_TIMEOUT]))
+    if CONF_RAW_STREAM_PORT in config:
+        cg.add(var.set_raw_stream_port(config[CONF_RAW_STREAM_PORT]))
+    cg.add(var.set_rx_task(config[CONF_RX_TASK]))
+
+    if CONF_SYNC_TIME in config:
+        sens = await sensor.new_sensor(config[CONF_SYNC_TIME])
+        cg.add(var.set_sync_time_sensor(sens))
+
+    cg.add(
+        var.set_nasa_poll_bus_utilisation(config[CONF_NASA_POLL_BUS_UTILISATION])
+    )
+
     # Mapping of config keys to their corresponding methods
     config_actions = {
         CONF_DEBUG_LOG_MESSAGES: var.set_debug_log_messages,
@@ -589,3 +762,87 @@ async def to_code(config):
 
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
+
+
+CONF_ADDRESSES = "addresses"
+CONF_BROADCAST = "broadcast"
+CONF_FAN_MODE = "fan_mode"
+
+CONTROL_GROUP_MODES = {
+    "auto": Mode.Auto,
+    "cool": Mode.Cool,
+    "dry": Mode.Dry,
+    "fan": Mode.Fan,
+    "heat": Mode.Heat,
+}
+
+CONTROL_GROUP_FAN_MODES = {
+    "auto": FanMode.Auto,
+    "low": FanMode.Low,
+    "mid": FanMode.Mid,
+    "high": FanMode.High,
+    "turbo": FanMode.Turbo,
+}
+
+
+def validate_control_group(config):
+    # a broadcast changes every NASA indoor unit, a list of addresses would suggest otherwise
+    if config[CONF_BROADCAST] and CONF_ADDRESSES in config:
+        raise cv.Invalid(
+            f"'{CONF_ADDRESSES}' can not be used with '{CONF_BROADCAST}', a broadcast controls every indoor unit"
+        )
+    if not config[CONF_BROADCAST] and CONF_ADDRESSES not in config:
+        raise cv.Invalid(f"'{CONF_ADDRESSES}' is required without '{CONF_BROADCAST}'")
+    return config
+
+
+CONTROL_GROUP_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(Samsung_AC),
+            cv.Optional(CONF_ADDRESSES): cv.ensure_list(cv.string),
+            # one frame for all NASA indoor units instead of one per address
+            cv.Optional(CONF_BROADCAST, default=False): cv.boolean,
+            cv.Optional(CONF_DEVICE_POWER): cv.templatable(cv.boolean),
+            cv.Optional(CONF_DEVICE_MODE): cv.templatable(
+                cv.enum(CONTROL_GROUP_MODES, lower=True)
+            ),
+            cv.Optional(CONF_DEVICE_TARGET_TEMPERATURE): cv.templatable(
+                cv.temperature
+            ),
+            cv.Optional(CONF_FAN_MODE): cv.templatable(
+                cv.enum(CONTROL_GROUP_FAN_MODES, lower=True)
+            ),
+        }
+    ),
+    validate_control_group,
+)
+
+
+@automation.register_action(
+    "samsung_ac.control_group", ControlGroupAction, CONTROL_GROUP_SCHEMA
+)
+async def control_group_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+
+    for address in config.get(CONF_ADDRESSES, []):
+        cg.add(var.add_address(address))
+    cg.add(var.set_broadcast(config[CONF_BROADCAST]))
+
+    if CONF_DEVICE_POWER in config:
+        template_ = await cg.templatable(config[CONF_DEVICE_POWER], args, bool)
+        cg.add(var.set_power(template_))
+    if CONF_DEVICE_MODE in config:
+        template_ = await cg.templatable(config[CONF_DEVICE_MODE], args, Mode)
+        cg.add(var.set_mode(template_))
+    if CONF_DEVICE_TARGET_TEMPERATURE in config:
+        template_ = await cg.templatable(
+            config[CONF_DEVICE_TARGET_TEMPERATURE], args, float
+        )
+        cg.add(var.set_target_temperature(template_))
+    if CONF_FAN_MODE in config:
+        template_ = await cg.templatable(config[CONF_FAN_MODE], args, FanMode)
+        cg.add(var.set_fan_mode(template_))
+
+    return var
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include "esphome/core/automation.h"
+#include "samsung_ac.h"
+
+namespace esphome
+{
+  namespace samsung_ac
+  {
+    template <typename... Ts>
+    class ControlGroupAction : public Action<Ts...>, public Parented<Samsung_AC>
+    {
+    public:
+      TEMPLATABLE_VALUE(bool, power)
+      TEMPLATABLE_VALUE(Mode, mode)
+      TEMPLATABLE_VALUE(float, target_temperature)
+      TEMPLATABLE_VALUE(FanMode, fan_mode)
+
+      void add_address(const std::string &address)
+      {
+        addresses_.push_back(address);
+      }
+
+      void set_broadcast(bool value)
+      {
+        broadcast_ = value;
+      }
+
+      void play(Ts... x) override
+      {
+        ProtocolRequest request;
+        if (this->power_.has_value())
+          request.power = this->power_.value(x...);
+        if (this->mode_.has_value())
+          request.mode = this->mode_.value(x...);
+        if (this->target_temperature_.has_value())
+          request.target_temp = this->target_temperature_.value(x...);
+        if (this->fan_mode_.has_value())
+          request.fan_mode = this->fan_mode_.value(x...);
+
+        this->parent_->publish_group_request(addresses_, request, broadcast_);
+      }
+
+    protected:
+      std::vector<std::string> addresses_;
+      bool broadcast_{false};
+    };
+
+  } // namespace samsung_ac
+} // namespace esphome
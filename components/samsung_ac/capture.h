@@ -0,0 +1,160 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace esphome
+{
+    namespace samsung_ac
+    {
+        // Binary capture of raw bus frames, streamed by RawStream and written/read by the tools in test/.
+        //
+        // header: "SACP" version(u8)
+        // record: time(u32 ms) direction(u8) length(u16) bytes[length]
+        //
+        // All numbers are little endian. A Dropped record carries the total number of frames
+        // (u32) which did not fit into the send buffer so far.
+        //
+        // Files may end with an index of the records, which is never streamed:
+        // entry: source(u32) message(u16) offset(u64)
+        // trailer: index offset(u64) entry count(u32) "SACI"
+        //
+        // Entries are sorted by source, message and offset. The source is a PackedAddress (see
+        // device_registry.h), the message a NASA message number or the NonNASA command, and the
+        // offset the file position of the record. Every indexed record has one entry with message
+        // captureAnyMessage, so all frames of a source can be found as well. Readers have to check
+        // for the trailer first, records end at the index offset.
+
+        enum class CaptureDirection : uint8_t
+        {
+            Received = 0,
+            Sent = 1,
+            Discarded = 2, // received bytes which could not be decoded
+            Dropped = 3
+        };
+
+        const uint8_t captureVersion = 1;
+        const size_t captureHeaderSize = 5;
+        const size_t captureRecordHeaderSize = 7;
+        const size_t captureIndexEntrySize = 14;
+        const size_t captureTrailerSize = 16;
+        const uint16_t captureAnyMessage = 0;
+
+        struct CaptureRecord
+        {
+            uint32_t time;
+            CaptureDirection direction;
+            const uint8_t *data;
+            uint16_t length;
+        };
+
+        struct CaptureIndexEntry
+        {
+            uint32_t source;
+            uint16_t message;
+            uint64_t offset;
+
+            bool operator<(const CaptureIndexEntry &other) const
+            {
+                if (source != other.source)
+                    return source < other.source;
+                if (message != other.message)
+                    return message < other.message;
+                return offset < other.offset;
+            }
+        };
+
+        inline void append_capture_le(std::vector<uint8_t> &out, uint64_t value, size_t size)
+        {
+            for (size_t i = 0; i < size; i++)
+                out.push_back((uint8_t)(value >> (8 * i)));
+        }
+
+        inline uint64_t read_capture_le(const uint8_t *data, size_t size)
+        {
+            uint64_t value = 0;
+            for (size_t i = 0; i < size; i++)
+                value |= (uint64_t)data[i] << (8 * i);
+            return value;
+        }
+
+        inline void append_capture_header(std::vector<uint8_t> &out)
+        {
+            out.insert(out.end(), {'S', 'A', 'C', 'P', captureVersion});
+        }
+
+        inline bool is_capture_header(const uint8_t *data, size_t size)
+        {
+            return size >= captureHeaderSize && data[0] == 'S' && data[1] == 'A' && data[2] == 'C' && data[3] == 'P' && data[4] == captureVersion;
+        }
+
+        inline void append_capture_record(std::vector<uint8_t> &out, uint32_t time, CaptureDirection direction, const uint8_t *data, uint16_t length)
+        {
+            out.insert(out.end(), {(uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24),
+                                   (uint8_t)direction, (uint8_t)length, (uint8_t)(length >> 8)});
+            out.insert(out.end(), data, data + length);
+        }
+
+        inline void append_capture_dropped(std::vector<uint8_t> &out, uint32_t time, uint32_t dropped)
+        {
+            const uint8_t count[4] = {(uint8_t)dropped, (uint8_t)(dropped >> 8), (uint8_t)(dropped >> 16), (uint8_t)(dropped >> 24)};
+            append_capture_record(out, time, CaptureDirection::Dropped, count, sizeof(count));
+        }
+
+        // returns the number of bytes of the record or 0 if the record is not complete yet
+        inline size_t parse_capture_record(const uint8_t *data, size_t size, CaptureRecord &record)
+        {
+            if (size < captureRecordHeaderSize)
+                return 0;
+
+            uint16_t length = data[5] | data[6] << 8;
+            if (size < captureRecordHeaderSize + length)
+                return 0;
+
+            record.time = data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+            record.direction = (CaptureDirection)data[4];
+            record.length = length;
+            record.data = data + captureRecordHeaderSize;
+            return captureRecordHeaderSize + length;
+        }
+
+        // sorts the entries and appends them together with the trailer, index_offset is the
+        // file position the index will be written to
+        inline void append_capture_index(std::vector<uint8_t> &out, std::vector<CaptureIndexEntry> &entries, uint64_t index_offset)
+        {
+            std::sort(entries.begin(), entries.end());
+            out.reserve(out.size() + entries.size() * captureIndexEntrySize + captureTrailerSize);
+            for (const auto &entry : entries)
+            {
+                append_capture_le(out, entry.source, 4);
+                append_capture_le(out, entry.message, 2);
+                append_capture_le(out, entry.offset, 8);
+            }
+            append_capture_le(out, index_offset, 8);
+            append_capture_le(out, entries.size(), 4);
+            out.insert(out.end(), {'S', 'A', 'C', 'I'});
+        }
+
+        inline CaptureIndexEntry read_capture_index_entry(const uint8_t *data)
+        {
+            return CaptureIndexEntry{(uint32_t)read_capture_le(data, 4), (uint16_t)read_capture_le(data + 4, 2), read_capture_le(data + 6, 8)};
+        }
+
+        // checks the trailer at the end of a complete file, returns false if there is no (valid) index
+        inline bool parse_capture_trailer(const uint8_t *data, size_t size, uint64_t &index_offset, uint32_t &entries)
+        {
+            if (size < captureHeaderSize + captureTrailerSize)
+                return false;
+
+            const uint8_t *trailer = data + size - captureTrailerSize;
+            if (trailer[12] != 'S' || trailer[13] != 'A' || trailer[14] != 'C' || trailer[15] != 'I')
+                return false;
+
+            index_offset = read_capture_le(trailer, 8);
+            entries = read_capture_le(trailer + 8, 4);
+            return index_offset >= captureHeaderSize && index_offset + (uint64_t)entries * captureIndexEntrySize + captureTrailerSize == size;
+        }
+    } // namespace samsung_ac
+} // namespace esphome
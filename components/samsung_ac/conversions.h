@@ -27,5 +27,36 @@ namespace esphome
 
     climate::ClimateSwingMode swingmode_to_climateswingmode(SwingMode swingMode);
     SwingMode climateswingmode_to_swingmode(climate::ClimateSwingMode swingMode);
+
+    enum class ValueType : uint8_t
+    {
+      Unsigned,
+      Signed16,
+      Signed32
+    };
+
+    // converts a raw message value into the value of a sensor, set up by codegen
+    struct ValueConverter
+    {
+      ValueType type{ValueType::Unsigned};
+      float multiply{1};
+      float offset{0};
+
+      float apply(long value) const
+      {
+        switch (type)
+        {
+        case ValueType::Signed16:
+          value = (int16_t)value;
+          break;
+        case ValueType::Signed32:
+          value = (int32_t)value;
+          break;
+        default:
+          break;
+        }
+        return (float)value * multiply + offset;
+      }
+    };
   } // namespace samsung_ac
 } // namespace esphome
@@ -1,5 +1,6 @@
 #include "esphome/core/log.h"
 #include "debug_mqtt.h"
+#include <deque>
 
 #if defined(USE_ESP8266)
 #include <AsyncMqttClient.h>
@@ -89,8 +90,60 @@ namespace esphome
             return esp_mqtt_client_publish(mqtt_client, topic.c_str(), payload.c_str(), payload.length(), 0, false) != -1;
 #endif
 #else
-        return false
+        return false;
 #endif
         }
+
+        struct DebugMqttMessage
+        {
+            std::string topic;
+            std::string payload;
+        };
+
+        static std::deque<DebugMqttMessage> debug_mqtt_queue;
+        static uint32_t debug_mqtt_dropped_count = 0;
+        static uint32_t debug_mqtt_reported_dropped = 0;
+
+        void debug_mqtt_enqueue(std::string &&topic, std::string &&payload)
+        {
+            if (debug_mqtt_queue.size() >= debugMqttQueueSize)
+            {
+                debug_mqtt_queue.pop_front();
+                debug_mqtt_dropped_count++;
+            }
+            debug_mqtt_queue.push_back(DebugMqttMessage{std::move(topic), std::move(payload)});
+        }
+
+        void debug_mqtt_flush()
+        {
+            if (debug_mqtt_queue.empty())
+                return;
+
+            if (!debug_mqtt_connected())
+            {
+                debug_mqtt_queue.clear();
+                return;
+            }
+
+            // stop at the first message the client does not accept, its buffer is full
+            while (!debug_mqtt_queue.empty())
+            {
+                const auto &message = debug_mqtt_queue.front();
+                if (!debug_mqtt_publish(message.topic, message.payload))
+                    return;
+                debug_mqtt_queue.pop_front();
+            }
+
+            if (debug_mqtt_reported_dropped != debug_mqtt_dropped_count &&
+                debug_mqtt_publish("samsung_ac/debug/dropped", std::to_string(debug_mqtt_dropped_count)))
+            {
+                debug_mqtt_reported_dropped = debug_mqtt_dropped_count;
+            }
+        }
+
+        uint32_t debug_mqtt_dropped()
+        {
+            return debug_mqtt_dropped_count;
+        }
     } // namespace samsung_ac
 } // namespace esphome
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 
 namespace esphome
 {
@@ -9,5 +10,13 @@ namespace esphome
         bool debug_mqtt_connected();
         void debug_mqtt_connect(const std::string &host, const uint16_t port, const std::string &username, const std::string &password);
         bool debug_mqtt_publish(const std::string &topic, const std::string &payload);
+
+        // number of messages waiting to be published, the oldest one is dropped when it is full
+        const uint8_t debugMqttQueueSize = 16;
+
+        // queues a message, it is published from the loop as soon as the client accepts it
+        void debug_mqtt_enqueue(std::string &&topic, std::string &&payload);
+        void debug_mqtt_flush();
+        uint32_t debug_mqtt_dropped();
     } // namespace samsung_ac
 } // namespace esphome
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include "protocol.h"
+
+namespace esphome
+{
+    namespace samsung_ac
+    {
+        inline PackedAddress pack_address(const std::string &address)
+        {
+            unsigned int klass, channel, addr;
+            if (address.size() == 2 && sscanf(address.c_str(), "%02x", &addr) == 1)
+                return nonNasaAddressFlag | addr;
+            if (address.size() == 8 && sscanf(address.c_str(), "%02x.%02x.%02x", &klass, &channel, &addr) == 3)
+                return klass << 16 | channel << 8 | addr;
+            return invalidPackedAddress;
+        }
+
+        inline std::string unpack_address(PackedAddress address)
+        {
+            char str[9];
+            if (address & nonNasaAddressFlag)
+                snprintf(str, sizeof(str), "%02x", address & 0xFF);
+            else
+                snprintf(str, sizeof(str), "%02x.%02x.%02x", (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF);
+            return str;
+        }
+
+        struct DiscoveredAddress
+        {
+            PackedAddress address;
+            AddressType type; // classified once when the address is added
+            bool online;
+            uint32_t first_seen; // start of the current online period
+            uint32_t last_seen;
+        };
+
+        enum class DiscoveryEvent
+        {
+            Added,  // first frame of an unknown or offline address
+            Removed // nothing received within the timeout
+        };
+
+        // All addresses seen on the bus, sorted by address. Addresses which go quiet are only marked
+        // offline, so the topology (and the stored copy of it) keeps them.
+        class DiscoveryRegistry
+        {
+        public:
+            typedef std::function<void(const DiscoveredAddress &, DiscoveryEvent)> Callback;
+
+            void add_on_change_callback(Callback &&callback)
+            {
+                callbacks_.push_back(std::move(callback));
+            }
+
+            // called for every frame, returns false if the address is unknown and has to be added
+            bool seen(PackedAddress address, uint32_t now)
+            {
+                // units send several frames in a row, so the last address is checked before searching.
+                // the index is validated by the address, inserts need not reset it
+                if (last_ >= addresses_.size() || addresses_[last_].address != address)
+                {
+                    auto found = lower_bound(address);
+                    if (found == addresses_.end() || found->address != address)
+                        return false;
+                    last_ = found - addresses_.begin();
+                }
+
+                auto it = addresses_.begin() + last_;
+                it->last_seen = now;
+                if (!it->online)
+                {
+                    it->online = true;
+                    it->first_seen = now;
+                    notify(*it, DiscoveryEvent::Added);
+                }
+                return true;
+            }
+
+            void add(PackedAddress address, AddressType type, uint32_t now)
+            {
+                auto it = lower_bound(address);
+                if (it != addresses_.end() && it->address == address)
+                {
+                    seen(address, now);
+                    return;
+                }
+
+                it = addresses_.insert(it, DiscoveredAddress{address, type, true, now, now});
+                notify(*it, DiscoveryEvent::Added);
+            }
+
+            // known from an earlier boot, offline until the first frame arrives
+            void restore(PackedAddress address, AddressType type)
+            {
+                auto it = lower_bound(address);
+                if (it == addresses_.end() || it->address != address)
+                    addresses_.insert(it, DiscoveredAddress{address, type, false, 0, 0});
+            }
+
+            // marks all addresses offline which were not seen for longer than timeout
+            void expire(uint32_t now, uint32_t timeout)
+            {
+                for (auto &entry : addresses_)
+                {
+                    if (entry.online && now - entry.last_seen > timeout)
+                    {
+                        entry.online = false;
+                        notify(entry, DiscoveryEvent::Removed);
+                    }
+                }
+            }
+
+            const DiscoveredAddress *find(PackedAddress address) const
+            {
+                auto it = std::lower_bound(addresses_.begin(), addresses_.end(), address, compare);
+                if (it != addresses_.end() && it->address == address)
+                    return &*it;
+                return nullptr;
+            }
+
+            size_t size() const { return addresses_.size(); }
+            bool empty() const { return addresses_.empty(); }
+            std::vector<DiscoveredAddress>::const_iterator begin() const { return addresses_.begin(); }
+            std::vector<DiscoveredAddress>::const_iterator end() const { return addresses_.end(); }
+
+            size_t memory_usage() const
+            {
+                return sizeof(*this) + addresses_.capacity() * sizeof(DiscoveredAddress);
+            }
+
+        protected:
+            static bool compare(const DiscoveredAddress &entry, PackedAddress value)
+            {
+                return entry.address < value;
+            }
+
+            std::vector<DiscoveredAddress>::iterator lower_bound(PackedAddress address)
+            {
+                return std::lower_bound(addresses_.begin(), addresses_.end(), address, compare);
+            }
+
+            void notify(const DiscoveredAddress &entry, DiscoveryEvent event)
+            {
+                for (auto &callback : callbacks_)
+                    callback(entry, event);
+            }
+
+            std::vector<DiscoveredAddress> addresses_;
+            std::vector<Callback> callbacks_;
+            size_t last_ = 0;
+        };
+
+        // Table of devices. The position of a device in registration order is its handle, which
+        // stays the same for the lifetime of the registry. Lookups by address use a sorted index.
+        template <typename T>
+        class DeviceRegistry
+        {
+        public:
+            static const uint8_t invalidHandle = 0xFF;
+
+            // returns the handle of the new device or invalidHandle if the address is already
+            // registered or the registry is full
+            uint8_t add(PackedAddress address, T device)
+            {
+                if (devices_.size() >= invalidHandle)
+                    return invalidHandle;
+
+                auto it = lower_bound(address);
+                if (it != index_.end() && addresses_[*it] == address)
+                    return invalidHandle;
+
+                uint8_t handle = devices_.size();
+                devices_.push_back(device);
+                addresses_.push_back(address);
+                index_.insert(it, handle);
+                return handle;
+            }
+
+            uint8_t find_handle(PackedAddress address) const
+            {
+                auto it = lower_bound(address);
+                if (it != index_.end() && addresses_[*it] == address)
+                    return *it;
+                return invalidHandle;
+            }
+
+            // returns T{} (nullptr for pointers) if there is no device with this address
+            T find(PackedAddress address) const
+            {
+                uint8_t handle = find_handle(address);
+                return handle == invalidHandle ? T{} : devices_[handle];
+            }
+
+            T get(uint8_t handle) const { return devices_[handle]; }
+            PackedAddress get_address(uint8_t handle) const { return addresses_[handle]; }
+
+            size_t size() const { return devices_.size(); }
+            bool empty() const { return devices_.empty(); }
+            typename std::vector<T>::const_iterator begin() const { return devices_.begin(); }
+            typename std::vector<T>::const_iterator end() const { return devices_.end(); }
+
+            size_t memory_usage() const
+            {
+                return sizeof(*this) + devices_.capacity() * sizeof(T) + addresses_.capacity() * sizeof(PackedAddress) + index_.capacity();
+            }
+
+        protected:
+            std::vector<uint8_t>::const_iterator lower_bound(PackedAddress address) const
+            {
+                return std::lower_bound(index_.begin(), index_.end(), address, [this](uint8_t handle, PackedAddress value)
+                                        { return addresses_[handle] < value; });
+            }
+
+            std::vector<T> devices_;
+            std::vector<PackedAddress> addresses_;
+            std::vector<uint8_t> index_; // handles sorted by address
+        };
+    } // namespace samsung_ac
+} // namespace esphome
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace esphome
+{
+    namespace samsung_ac
+    {
+        // Framing of both protocols on raw bytes, shared by the decoders, the RX task and the
+        // capture tools in test/. Works on a pointer so received buffers and mapped files need no copy.
+
+        const uint8_t frameStart = 0x32;
+        const uint8_t frameEnd = 0x34;
+        const size_t nonNasaFrameSize = 14;
+        const size_t nasaMinFrameSize = 14;
+        const size_t nasaMaxFrameSize = 1500;
+
+        // crc of a NASA frame, over the bytes between the size and the crc
+        inline uint16_t frame_crc16(const uint8_t *data, size_t length)
+        {
+            uint16_t crc = 0;
+            for (size_t index = 0; index < length; ++index)
+            {
+                crc = crc ^ ((uint16_t)data[index] << 8);
+                for (uint8_t i = 0; i < 8; i++)
+                {
+                    if (crc & 0x8000)
+                        crc = (crc << 1) ^ 0x1021;
+                    else
+                        crc <<= 1;
+                }
+            }
+            return crc;
+        }
+
+        // checksum of a NonNASA frame, over the bytes between the start and the checksum
+        inline uint8_t frame_checksum(const uint8_t *data)
+        {
+            uint8_t sum = data[1];
+            for (uint8_t i = 2; i < 12; i++)
+                sum = sum ^ data[i];
+            return sum;
+        }
+
+        // index of the next possible frame start at or after from, size if there is none
+        inline size_t next_frame_start(const uint8_t *data, size_t size, size_t from)
+        {
+            while (from < size && data[from] != frameStart)
+                from++;
+            return from;
+        }
+
+        // Splits the received bytes into frames of either protocol without decoding them.
+        // Returns the length of the valid frame at the start of data, 0 if more bytes are needed
+        // to tell, or the negative number of bytes up to the next possible frame start which are
+        // no frame and have to be discarded. A caller which has no more bytes coming (e.g. at the
+        // end of a capture) discards up to next_frame_start(data, size, 1) when 0 is returned.
+        inline int frame_length(const uint8_t *data, size_t size)
+        {
+            if (size == 0)
+                return 0;
+            if (data[0] != frameStart)
+                return -(int)next_frame_start(data, size, 0);
+
+            const size_t nasa_size = size >= 3 ? (size_t)data[1] << 8 | data[2] : 0;
+            const bool nasa = nasa_size >= nasaMinFrameSize && nasa_size <= nasaMaxFrameSize;
+            if (nasa && nasa_size + 2 <= size && data[nasa_size + 1] == frameEnd &&
+                frame_crc16(data + 3, nasa_size - 4) == ((uint16_t)data[nasa_size - 1] << 8 | data[nasa_size]))
+                return nasa_size + 2;
+
+            // the addresses of a NonNASA frame can look like a NASA size, so it is checked either way
+            if (size >= nonNasaFrameSize && data[nonNasaFrameSize - 1] == frameEnd && data[12] == frame_checksum(data))
+                return nonNasaFrameSize;
+
+            // a NASA frame might still be arriving
+            if (size < nonNasaFrameSize || (nasa && nasa_size + 2 > size))
+                return 0;
+
+            return -(int)next_frame_start(data, size, 1);
+        }
+    } // namespace samsung_ac
+} // namespace esphome
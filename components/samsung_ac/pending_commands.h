@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace esphome
+{
+  namespace samsung_ac
+  {
+    // time a unit gets to report a commanded value before its reports are trusted again
+    const uint16_t commandConfirmTimeout = 10000;
+
+    // settings which can be controlled, each one can have a single command waiting for confirmation
+    enum class ControlField : uint8_t
+    {
+      Power,
+      AutomaticCleaning,
+      WaterHeaterPower,
+      Mode,
+      WaterHeaterMode,
+      FanMode,
+      AltMode,
+      SwingVertical,
+      SwingHorizontal,
+      TargetTemperature, // tenths of a degree, like all temperatures
+      WaterOutletTarget,
+      TargetWaterTemperature,
+      Count
+    };
+
+    inline const char *control_field_to_str(ControlField field)
+    {
+      switch (field)
+      {
+      case ControlField::Power:
+        return "power";
+      case ControlField::AutomaticCleaning:
+        return "automatic_cleaning";
+      case ControlField::WaterHeaterPower:
+        return "water_heater_power";
+      case ControlField::Mode:
+        return "mode";
+      case ControlField::WaterHeaterMode:
+        return "water_heater_mode";
+      case ControlField::FanMode:
+        return "fan_mode";
+      case ControlField::AltMode:
+        return "alt_mode";
+      case ControlField::SwingVertical:
+        return "swing_vertical";
+      case ControlField::SwingHorizontal:
+        return "swing_horizontal";
+      case ControlField::TargetTemperature:
+        return "target_temperature";
+      case ControlField::WaterOutletTarget:
+        return "water_outlet_target";
+      case ControlField::TargetWaterTemperature:
+        return "target_water_temperature";
+      default:
+        return "unknown";
+      }
+    }
+
+    enum class PendingResult
+    {
+      None,      // nothing pending, publish the value
+      Confirmed, // the unit reports the commanded value
+      Stale,     // the unit still reports the old value, don't publish it
+      Timeout    // the command was not applied in time, publish what the unit reports
+    };
+
+    // Commands sent to a device whose values were already published. Reports from the unit which
+    // still contain the old value are suppressed until the new one is confirmed or the command
+    // timed out, so the UI does not jump back and forth.
+    class PendingCommands
+    {
+    public:
+      void command(ControlField field, long value, uint32_t now)
+      {
+        Pending &pending = pending_[(size_t)field];
+        pending.active = true;
+        pending.value = value;
+        pending.since = now;
+      }
+
+      void cancel(ControlField field)
+      {
+        pending_[(size_t)field].active = false;
+      }
+
+      // the command was held back (debounced) and is only sent now
+      void restart(ControlField field, uint32_t now)
+      {
+        pending_[(size_t)field].since = now;
+      }
+
+      PendingResult report(ControlField field, long value, uint32_t now)
+      {
+        Pending &pending = pending_[(size_t)field];
+        if (!pending.active)
+          return PendingResult::None;
+
+        if (pending.value == value)
+        {
+          pending.active = false;
+          last_latency_ = now - pending.since;
+          return PendingResult::Confirmed;
+        }
+
+        if (now - pending.since < commandConfirmTimeout)
+          return PendingResult::Stale;
+
+        pending.active = false;
+        return PendingResult::Timeout;
+      }
+
+      bool is_pending(ControlField field) const
+      {
+        return pending_[(size_t)field].active;
+      }
+
+      // time between the last command and its confirmation
+      uint32_t last_latency() const
+      {
+        return last_latency_;
+      }
+
+    protected:
+      struct Pending
+      {
+        bool active;
+        int32_t value;
+        uint32_t since;
+      };
+
+      std::array<Pending, (size_t)ControlField::Count> pending_{};
+      uint32_t last_latency_ = 0;
+    };
+  } // namespace samsung_ac
+} // namespace esphome
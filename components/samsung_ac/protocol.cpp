@@ -9,6 +9,7 @@ namespace esphome
     namespace samsung_ac
     {
         ProtocolProcessing protocol_processing = ProtocolProcessing::Auto;
+        bool passive_mode = false;
 
         uint16_t skip_data(std::vector<uint8_t> &data, int from)
         {
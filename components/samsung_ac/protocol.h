@@ -10,6 +10,12 @@ namespace esphome
     {
         extern bool non_nasa_keepalive;
 
+        // listen only, nothing is ever written to the bus
+        extern bool passive_mode;
+
+        // share of the bus time (0..1) the NASA poll scheduler may use for its read requests
+        extern float nasa_poll_bus_utilisation;
+
         enum class DecodeResultType
         {
             Fill = 1,
@@ -53,6 +59,38 @@ namespace esphome
             Off = 5
         };
 
+        // temperature in tenths of a degree celsius, as the units send them.
+        // only converted to float when it is published.
+        struct Temperature
+        {
+            int16_t tenths = 0;
+
+            static Temperature from_tenths(long value)
+            {
+                return Temperature{(int16_t)value};
+            }
+
+            static Temperature from_degrees(int value)
+            {
+                return Temperature{(int16_t)(value * 10)};
+            }
+
+            float to_float() const
+            {
+                return tenths / 10.0f;
+            }
+
+            bool operator==(const Temperature &other) const
+            {
+                return tenths == other.tenths;
+            }
+
+            bool operator!=(const Temperature &other) const
+            {
+                return tenths != other.tenths;
+            }
+        };
+
         typedef std::string AltModeName;
         typedef uint8_t AltMode;
 
@@ -70,35 +108,45 @@ namespace esphome
             All = 3
         };
 
+        // Addresses packed into 32 bits. NASA addresses "cc.hh.aa" use the lower 24 bits,
+        // NonNASA addresses "aa" are marked with bit 24 so both fit into the same tables.
+        // See pack_address and unpack_address in device_registry.h.
+        typedef uint32_t PackedAddress;
+
+        const PackedAddress invalidPackedAddress = 0xFFFFFFFF;
+        const PackedAddress nonNasaAddressFlag = 0x01000000;
+
+        // Receives the decoded values. The protocols pass the packed source address, so nothing
+        // is formatted or parsed per frame.
         class MessageTarget
         {
         public:
             virtual uint32_t get_miliseconds() = 0;
             virtual void publish_data(uint8_t id, std::vector<uint8_t> &&data) = 0;
             virtual void ack_data(uint8_t id) = 0;
-            virtual void register_address(const std::string address) = 0;
-            virtual void set_power(const std::string address, bool value) = 0;
-            virtual void set_automatic_cleaning(const std::string address, bool value) = 0;
-            virtual void set_water_heater_power(const std::string address, bool value) = 0;
-            virtual void set_room_temperature(const std::string address, float value) = 0;
-            virtual void set_target_temperature(const std::string address, float value) = 0;
-            virtual void set_water_outlet_target(const std::string address, float value) = 0;
-            virtual void set_outdoor_temperature(const std::string address, float value) = 0;
-            virtual void set_indoor_eva_in_temperature(const std::string address, float value) = 0;
-            virtual void set_indoor_eva_out_temperature(const std::string address, float value) = 0;
-            virtual void set_target_water_temperature(const std::string address, float value) = 0;
-            virtual void set_mode(const std::string address, Mode mode) = 0;
-            virtual void set_water_heater_mode(const std::string address, WaterHeaterMode waterheatermode) = 0;
-            virtual void set_fanmode(const std::string address, FanMode fanmode) = 0;
-            virtual void set_altmode(const std::string address, AltMode altmode) = 0;
-            virtual void set_swing_vertical(const std::string address, bool vertical) = 0;
-            virtual void set_swing_horizontal(const std::string address, bool horizontal) = 0;
-            virtual void set_custom_sensor(const std::string address, uint16_t message_number, float value) = 0;
-            virtual void set_error_code(const std::string address, int error_code) = 0;
-            virtual void set_outdoor_instantaneous_power(const std::string &address, float value) = 0;
-            virtual void set_outdoor_cumulative_energy(const std::string &address, float value) = 0;
-            virtual void set_outdoor_current(const std::string &address, float value) = 0;
-            virtual void set_outdoor_voltage(const std::string &address, float value) = 0;
+            virtual void register_address(PackedAddress address) = 0;
+            virtual void set_power(PackedAddress address, bool value) = 0;
+            virtual void set_automatic_cleaning(PackedAddress address, bool value) = 0;
+            virtual void set_water_heater_power(PackedAddress address, bool value) = 0;
+            virtual void set_room_temperature(PackedAddress address, Temperature value) = 0;
+            virtual void set_target_temperature(PackedAddress address, Temperature value) = 0;
+            virtual void set_water_outlet_target(PackedAddress address, Temperature value) = 0;
+            virtual void set_outdoor_temperature(PackedAddress address, Temperature value) = 0;
+            virtual void set_indoor_eva_in_temperature(PackedAddress address, Temperature value) = 0;
+            virtual void set_indoor_eva_out_temperature(PackedAddress address, Temperature value) = 0;
+            virtual void set_target_water_temperature(PackedAddress address, Temperature value) = 0;
+            virtual void set_mode(PackedAddress address, Mode mode) = 0;
+            virtual void set_water_heater_mode(PackedAddress address, WaterHeaterMode waterheatermode) = 0;
+            virtual void set_fanmode(PackedAddress address, FanMode fanmode) = 0;
+            virtual void set_altmode(PackedAddress address, AltMode altmode) = 0;
+            virtual void set_swing_vertical(PackedAddress address, bool vertical) = 0;
+            virtual void set_swing_horizontal(PackedAddress address, bool horizontal) = 0;
+            virtual void set_custom_sensor(PackedAddress address, uint16_t message_number, long value) = 0;
+            virtual void set_error_code(PackedAddress address, int error_code) = 0;
+            virtual void set_outdoor_instantaneous_power(PackedAddress address, float value) = 0;
+            virtual void set_outdoor_cumulative_energy(PackedAddress address, float value) = 0;
+            virtual void set_outdoor_current(PackedAddress address, float value) = 0;
+            virtual void set_outdoor_voltage(PackedAddress address, float value) = 0;
         };
 
         struct ProtocolRequest
@@ -115,13 +163,51 @@ namespace esphome
             optional<FanMode> fan_mode;
             optional<SwingMode> swing_mode;
             optional<AltMode> alt_mode;
+
+            bool empty() const
+            {
+                return !power && !automatic_cleaning && !water_heater_power && !mode && !waterheatermode && !target_temp &&
+                       !water_outlet_target && !target_water_temp && !fan_mode && !swing_mode && !alt_mode;
+            }
+
+            // takes all values set in other, they replace the ones set here
+            void merge(const ProtocolRequest &other)
+            {
+                if (other.power)
+                    power = other.power;
+                if (other.automatic_cleaning)
+                    automatic_cleaning = other.automatic_cleaning;
+                if (other.water_heater_power)
+                    water_heater_power = other.water_heater_power;
+                if (other.mode)
+                    mode = other.mode;
+                if (other.waterheatermode)
+                    waterheatermode = other.waterheatermode;
+                if (other.target_temp)
+                    target_temp = other.target_temp;
+                if (other.water_outlet_target)
+                    water_outlet_target = other.water_outlet_target;
+                if (other.target_water_temp)
+                    target_water_temp = other.target_water_temp;
+                if (other.fan_mode)
+                    fan_mode = other.fan_mode;
+                if (other.swing_mode)
+                    swing_mode = other.swing_mode;
+                if (other.alt_mode)
+                    alt_mode = other.alt_mode;
+            }
         };
 
         class Protocol
         {
         public:
             virtual void publish_request(MessageTarget *target, const std::string &address, ProtocolRequest &request) = 0;
+            // sends the same request to all addresses. broadcast sends a single frame to every indoor unit
+            // instead, addresses is empty then
+            virtual void publish_group_request(MessageTarget *target, const std::vector<std::string> &addresses, ProtocolRequest &request, bool broadcast) = 0;
             virtual void protocol_update(MessageTarget *target) = 0;
+            virtual void add_poll_message(const std::string &address, uint16_t message_number, uint32_t interval) = 0;
+            virtual void request_read(const std::string &address, uint16_t message_number) = 0;
         };
 
         enum class ProtocolProcessing
@@ -137,6 +223,9 @@ namespace esphome
 
         Protocol *get_protocol(const std::string &address);
 
+        // also takes the requests which address no single unit
+        extern Protocol *nasaProtocol;
+
         bool is_nasa_address(const std::string &address);
 
         enum class AddressType
@@ -1,9 +1,11 @@
 #include <set>
+#include <algorithm>
 #include "samsung_ac_log.h"
 #include "esphome/core/util.h"
 #include "esphome/core/hal.h"
 #include "util.h"
 #include "protocol_nasa.h"
+#include "frame.h"
 #include "debug_mqtt.h"
 
 esphome::samsung_ac::Packet packet_;
@@ -19,13 +21,6 @@ namespace esphome
             uint32_t last_sent_time;
         };
 
-        int variable_to_signed(int value)
-        {
-            if (value < 65535 /*uint16 max*/)
-                return value;
-            return value - (int)65535 /*uint16 max*/ - 1.0;
-        }
-
 #define LOG_MESSAGE(message_name, temp, source, dest)                                                             \
     if (debug_log_messages)                                                                                       \
     {                                                                                                             \
@@ -34,19 +29,7 @@ namespace esphome
 
         uint16_t crc16(std::vector<uint8_t> &data, int startIndex, int length)
         {
-            uint16_t crc = 0;
-            for (int index = startIndex; index < startIndex + length; ++index)
-            {
-                crc = crc ^ ((uint16_t)((uint8_t)data[index]) << 8);
-                for (uint8_t i = 0; i < 8; i++)
-                {
-                    if (crc & 0x8000)
-                        crc = (crc << 1) ^ 0x1021;
-                    else
-                        crc <<= 1;
-                }
-            }
-            return crc;
+            return frame_crc16(data.data() + startIndex, length);
         };
 
         Address Address::get_my_address()
@@ -263,24 +246,27 @@ namespace esphome
         DecodeResult Packet::decode(std::vector<uint8_t> &data)
         {
             if (data[0] != 0x32)
-                return DecodeResult::InvalidStartByte;
+                return { DecodeResultType::Discard };
 
-            if (data.size() < 16 || data.size() > 1500)
-                return DecodeResult::UnexpectedSize;
+            if (data.size() < 3)
+                return { DecodeResultType::Fill };
 
-            int size = (int)data[1] << 8 | (int)data[2];
-            if (size + 2 != data.size())
-                return DecodeResult::SizeDidNotMatch;
+            const int size = (int)data[1] << 8 | (int)data[2];
+            if (size < 14 || size > 1500)
+                return { DecodeResultType::Discard };
 
-            if (data[data.size() - 1] != 0x34)
-                return DecodeResult::InvalidEndByte;
+            if (size + 2 > (int)data.size())
+                return { DecodeResultType::Fill };
+
+            if (data[size + 1] != 0x34)
+                return { DecodeResultType::Discard };
 
             uint16_t crc_actual = crc16(data, 3, size - 4);
-            uint16_t crc_expected = (int)data[data.size() - 3] << 8 | (int)data[data.size() - 2];
+            uint16_t crc_expected = (int)data[size - 1] << 8 | (int)data[size];
             if (crc_expected != crc_actual)
             {
                 ESP_LOGW(TAG, "NASA: invalid crc - got %d but should be %d: %s", crc_actual, crc_expected, bytes_to_hex(data).c_str());
-                return DecodeResult::CrcError;
+                return { DecodeResultType::Discard };
             }
 
             unsigned int cursor = 3;
@@ -305,7 +291,7 @@ namespace esphome
                 cursor += set.size;
             }
 
-            return DecodeResult::Ok;
+            return { DecodeResultType::Processed, (uint16_t)(size + 2) };
         };
 
         std::vector<uint8_t> Packet::encode()
@@ -377,9 +363,9 @@ namespace esphome
             }
         }
 
-        void NasaProtocol::publish_request(MessageTarget *target, const std::string &address, ProtocolRequest &request)
+        std::vector<MessageSet> request_to_messages(ProtocolRequest &request)
         {
-            Packet packet = Packet::createa_partial(Address::parse(address), DataType::Request);
+            std::vector<MessageSet> messages;
 
             if (request.mode)
             {
@@ -387,7 +373,7 @@ namespace esphome
 
                 MessageSet mode(MessageNumber::ENUM_in_operation_mode);
                 mode.value = (int)request.mode.value();
-                packet.messages.push_back(mode);
+                messages.push_back(mode);
             }
 
             if (request.waterheatermode)
@@ -396,85 +382,140 @@ namespace esphome
 
                 MessageSet waterheatermode(MessageNumber::ENUM_in_water_heater_mode);
                 waterheatermode.value = (int)request.waterheatermode.value();
-                packet.messages.push_back(waterheatermode);
+                messages.push_back(waterheatermode);
             }
 
             if (request.power)
             {
                 MessageSet power(MessageNumber::ENUM_in_operation_power);
                 power.value = request.power.value() ? 1 : 0;
-                packet.messages.push_back(power);
+                messages.push_back(power);
             }
 
             if (request.automatic_cleaning)
             {
                 MessageSet automatic_cleaning(MessageNumber::ENUM_in_operation_automatic_cleaning);
                 automatic_cleaning.value = request.automatic_cleaning.value() ? 1 : 0;
-                packet.messages.push_back(automatic_cleaning);
+                messages.push_back(automatic_cleaning);
             }
 
             if (request.water_heater_power)
             {
                 MessageSet waterheaterpower(MessageNumber::ENUM_in_water_heater_power);
                 waterheaterpower.value = request.water_heater_power.value() ? 1 : 0;
-                packet.messages.push_back(waterheaterpower);
+                messages.push_back(waterheaterpower);
             }
 
             if (request.target_temp)
             {
                 MessageSet targettemp(MessageNumber::VAR_in_temp_target_f);
                 targettemp.value = request.target_temp.value() * 10.0;
-                packet.messages.push_back(targettemp);
+                messages.push_back(targettemp);
             }
 
             if (request.water_outlet_target)
             {
                 MessageSet wateroutlettarget(MessageNumber::VAR_in_temp_water_outlet_target_f);
                 wateroutlettarget.value = request.water_outlet_target.value() * 10.0;
-                packet.messages.push_back(wateroutlettarget);
+                messages.push_back(wateroutlettarget);
             }
 
             if (request.target_water_temp)
             {
                 MessageSet targetwatertemp(MessageNumber::VAR_in_temp_water_heater_target_f);
                 targetwatertemp.value = request.target_water_temp.value() * 10.0;
-                packet.messages.push_back(targetwatertemp);
+                messages.push_back(targetwatertemp);
             }
 
             if (request.fan_mode)
             {
                 MessageSet fanmode(MessageNumber::ENUM_in_fan_mode);
                 fanmode.value = fanmode_to_nasa_fanmode(request.fan_mode.value());
-                packet.messages.push_back(fanmode);
+                messages.push_back(fanmode);
             }
 
             if (request.alt_mode)
             {
                 MessageSet altmode(MessageNumber::ENUM_in_alt_mode);
                 altmode.value = request.alt_mode.value();
-                packet.messages.push_back(altmode);
+                messages.push_back(altmode);
             }
 
             if (request.swing_mode)
             {
                 MessageSet hl_swing(MessageNumber::ENUM_in_louver_hl_swing);
                 hl_swing.value = static_cast<uint8_t>(request.swing_mode.value()) & 1;
-                packet.messages.push_back(hl_swing);
+                messages.push_back(hl_swing);
 
                 MessageSet lr_swing(MessageNumber::ENUM_in_louver_lr_swing);
                 lr_swing.value = (static_cast<uint8_t>(request.swing_mode.value()) >> 1) & 1;
-                packet.messages.push_back(lr_swing);
+                messages.push_back(lr_swing);
             }
 
-            if (packet.messages.size() == 0)
-                return;
+            return messages;
+        }
+
+        void publish_request_packet(MessageTarget *target, Address da, const std::vector<MessageSet> &messages)
+        {
+            Packet packet = Packet::createa_partial(da, DataType::Request);
+            packet.messages = messages;
 
             LOGW("publish packet %s", packet.to_string().c_str());
 
             auto data = packet.encode();
             target->publish_data(0, std::move(data));
 
-            sent_packets.push_back({packet, 0, millis()});
+            // an older request which only sets values this one sets again does not need retries anymore
+            auto superseded = [&da, &messages](const PacketInfo &info)
+            {
+                if (!(info.packet.da == da))
+                    return false;
+                for (const auto &old : info.packet.messages)
+                {
+                    auto found = std::find_if(messages.begin(), messages.end(), [&old](const MessageSet &message)
+                                              { return message.messageNumber == old.messageNumber; });
+                    if (found == messages.end())
+                        return false;
+                }
+                return true;
+            };
+            sent_packets.erase(std::remove_if(sent_packets.begin(), sent_packets.end(), superseded), sent_packets.end());
+
+            sent_packets.push_back({packet, 0, target->get_miliseconds()});
+        }
+
+        void NasaProtocol::publish_request(MessageTarget *target, const std::string &address, ProtocolRequest &request)
+        {
+            auto messages = request_to_messages(request);
+            if (messages.size() == 0)
+                return;
+
+            publish_request_packet(target, Address::parse(address), messages);
+        }
+
+        void NasaProtocol::publish_group_request(MessageTarget *target, const std::vector<std::string> &addresses, ProtocolRequest &request, bool broadcast)
+        {
+            auto messages = request_to_messages(request);
+            if (messages.size() == 0)
+                return;
+
+            if (broadcast)
+            {
+                // every indoor unit on the control layer takes the request. There is no single
+                // unit to acknowledge it, so it is sent once and not tracked for retries.
+                Packet packet = Packet::createa_partial(Address{AddressClass::BroadcastControlLayer, 0xFF, 0xFF}, DataType::Request);
+                packet.messages = std::move(messages);
+
+                LOGW("publish broadcast packet %s", packet.to_string().c_str());
+                target->publish_data(0, packet.encode());
+                return;
+            }
+
+            // all frames go out right away, the acks and retries of the units overlap
+            for (const auto &address : addresses)
+            {
+                publish_request_packet(target, Address::parse(address), messages);
+            }
         }
 
         Mode operation_mode_to_mode(int value)
@@ -545,71 +586,71 @@ namespace esphome
             }
         }
 
-        void process_messageset(std::string source, std::string dest, MessageSet &message, MessageTarget *target)
+        // all values of the current packet as one message, e.g.
+        // {"sa":"20.00.00","da":"b0.ff.ff","m":{"4000":1,"4203":235}}
+        void debug_mqtt_packet(const std::string &source, const std::string &dest)
         {
-            if (debug_mqtt_connected())
-            {
-                static const std::string topic_prefix = "samsung_ac/nasa/";
-                std::string topic_suffix;
-                std::string payload;
-
-                if (static_cast<int>(message.messageNumber) != 0)
-                {
-                    topic_suffix = long_to_hex((uint16_t)message.messageNumber);
-                    payload = std::to_string(message.value);
-                }
-                else
-                {
-                    topic_suffix.clear();
-                    payload.clear();
-                }
+            if (!debug_mqtt_connected())
+                return;
 
-                switch (message.type)
-                {
-                case MessageSetType::Enum:
-                    debug_mqtt_publish(topic_prefix + "enum/" + topic_suffix, payload);
-                    break;
-                case MessageSetType::Variable:
-                    debug_mqtt_publish(topic_prefix + "var/" + topic_suffix, payload);
-                    break;
-                case MessageSetType::LongVariable:
-                    debug_mqtt_publish(topic_prefix + "var_long/" + topic_suffix, payload);
-                    break;
-                default:
-                    break;
-                }
-            }
+            std::string payload;
+            payload.reserve(32 + packet_.messages.size() * 16);
+            payload += "{\"sa\":\"";
+            payload += source;
+            payload += "\",\"da\":\"";
+            payload += dest;
+            payload += "\",\"m\":{";
+
+            bool first = true;
+            for (const auto &message : packet_.messages)
+            {
+                if (message.type == MessageSetType::Structure || message.messageNumber == MessageNumber::Undefiend)
+                    continue;
+                if (!first)
+                    payload += ',';
+                first = false;
+                payload += '"';
+                payload += long_to_hex((uint16_t)message.messageNumber);
+                payload += "\":";
+                payload += std::to_string(message.value);
+            }
+            payload += "}}";
+
+            debug_mqtt_enqueue("samsung_ac/nasa/packet", std::move(payload));
+        }
 
-            target->set_custom_sensor(source, (uint16_t)message.messageNumber, (float)message.value);
+        void process_messageset(const std::string &source, const std::string &dest, PackedAddress address, MessageSet &message, MessageTarget *target)
+        {
+            target->set_custom_sensor(address, (uint16_t)message.messageNumber, message.value);
 
             switch (message.messageNumber)
             {
             case MessageNumber::VAR_in_temp_room_f: // unit = 'Celsius' from XML
             {
-                double temp = (double)message.value / (double)10;
-                LOG_MESSAGE(VAR_in_temp_room_f, temp, source, dest);
-                target->set_room_temperature(source, temp);
+                auto temp = Temperature::from_tenths(message.value);
+                LOG_MESSAGE(VAR_in_temp_room_f, temp.to_float(), source, dest);
+                target->set_room_temperature(address, temp);
                 break;
             }
             case MessageNumber::VAR_in_temp_target_f: // unit = 'Celsius' from XML
             {
-                double temp = (double)message.value / (double)10;
-                LOG_MESSAGE(VAR_in_temp_target_f, temp, source, dest);
-                target->set_target_temperature(source, temp);
+                auto temp = Temperature::from_tenths(message.value);
+                LOG_MESSAGE(VAR_in_temp_target_f, temp.to_float(), source, dest);
+                target->set_target_temperature(address, temp);
                 break;
             }
             case MessageNumber::VAR_in_temp_water_outlet_target_f: // unit = 'Celsius' from XML
             {
-                double temp = (double)message.value / (double)10;
-                LOG_MESSAGE(VAR_in_temp_water_outlet_target_f, temp, source, dest);
-                target->set_water_outlet_target(source, temp);
+                auto temp = Temperature::from_tenths(message.value);
+                LOG_MESSAGE(VAR_in_temp_water_outlet_target_f, temp.to_float(), source, dest);
+                target->set_water_outlet_target(address, temp);
                 break;
             }
             case MessageNumber::VAR_in_temp_water_heater_target_f: // unit = 'Celsius' from XML
             {
-                double temp = (double)message.value / (double)10;
-                LOG_MESSAGE(VAR_in_temp_water_heater_target_f, temp, source, dest);
-                target->set_target_water_temperature(source, temp);
+                auto temp = Temperature::from_tenths(message.value);
+                LOG_MESSAGE(VAR_in_temp_water_heater_target_f, temp.to_float(), source, dest);
+                target->set_target_water_temperature(address, temp);
                 break;
             }
             case MessageNumber::ENUM_in_state_humidity_percent:
@@ -620,31 +661,31 @@ namespace esphome
             case MessageNumber::ENUM_in_operation_power:
             {
                 LOG_MESSAGE(ENUM_in_operation_power, (double)message.value, source, dest);
-                target->set_power(source, message.value != 0);
+                target->set_power(address, message.value != 0);
                 break;
             }
             case MessageNumber::ENUM_in_operation_automatic_cleaning:
             {
                 LOG_MESSAGE(ENUM_in_operation_automatic_cleaning, (double)message.value, source, dest);
-                target->set_automatic_cleaning(source, message.value != 0);
+                target->set_automatic_cleaning(address, message.value != 0);
                 break;
             }
             case MessageNumber::ENUM_in_water_heater_power:
             {
                 LOG_MESSAGE(ENUM_in_water_heater_power, (double)message.value, source, dest);
-                target->set_water_heater_power(source, message.value != 0);
+                target->set_water_heater_power(address, message.value != 0);
                 break;
             }
             case MessageNumber::ENUM_in_operation_mode:
             {
                 LOG_MESSAGE(ENUM_in_operation_mode, (double)message.value, source, dest);
-                target->set_mode(source, operation_mode_to_mode(message.value));
+                target->set_mode(address, operation_mode_to_mode(message.value));
                 break;
             }
             case MessageNumber::ENUM_in_water_heater_mode:
             {
                 LOG_MESSAGE(ENUM_in_water_heater_mode, (double)message.value, source, dest);
-                target->set_water_heater_mode(source, water_heater_mode_to_waterheatermode(message.value));
+                target->set_water_heater_mode(address, water_heater_mode_to_waterheatermode(message.value));
                 return;
             }
             case MessageNumber::ENUM_in_fan_mode:
@@ -661,7 +702,7 @@ namespace esphome
                     mode = FanMode::High;
                 else if (message.value == 4)
                     mode = FanMode::Turbo;
-                target->set_fanmode(source, mode);
+                target->set_fanmode(address, mode);
                 break;
             }
             case MessageNumber::ENUM_in_fan_mode_real:
@@ -672,19 +713,19 @@ namespace esphome
             case MessageNumber::ENUM_in_alt_mode:
             {
                 LOG_MESSAGE(ENUM_in_alt_mode, (double)message.value, source, dest);
-                target->set_altmode(source, message.value);
+                target->set_altmode(address, message.value);
                 break;
             }
             case MessageNumber::ENUM_in_louver_hl_swing:
             {
                 LOG_MESSAGE(ENUM_in_louver_hl_swing, (double)message.value, source, dest);
-                target->set_swing_vertical(source, message.value == 1);
+                target->set_swing_vertical(address, message.value == 1);
                 break;
             }
             case MessageNumber::ENUM_in_louver_lr_swing:
             {
                 LOG_MESSAGE(ENUM_in_louver_lr_swing, (double)message.value, source, dest);
-                target->set_swing_horizontal(source, message.value == 1);
+                target->set_swing_horizontal(address, message.value == 1);
                 break;
             }
             case MessageNumber::VAR_in_temp_water_tank_f:
@@ -694,23 +735,23 @@ namespace esphome
             }
             case MessageNumber::VAR_out_sensor_airout:
             {
-                double temp = (double)((int16_t)message.value) / (double)10;
-                LOG_MESSAGE(VAR_out_sensor_airout, temp, source, dest);
-                target->set_outdoor_temperature(source, temp);
+                auto temp = Temperature::from_tenths(message.value);
+                LOG_MESSAGE(VAR_out_sensor_airout, temp.to_float(), source, dest);
+                target->set_outdoor_temperature(address, temp);
                 break;
             }
             case MessageNumber::VAR_in_temp_eva_in_f:
             {
-                double temp = ((int16_t)message.value) / 10.0;
-                LOG_MESSAGE(VAR_in_temp_eva_in_f, temp, source, dest);
-                target->set_indoor_eva_in_temperature(source, temp);
+                auto temp = Temperature::from_tenths(message.value);
+                LOG_MESSAGE(VAR_in_temp_eva_in_f, temp.to_float(), source, dest);
+                target->set_indoor_eva_in_temperature(address, temp);
                 break;
             }
             case MessageNumber::VAR_in_temp_eva_out_f:
             {
-                double temp = ((int16_t)message.value) / 10.0;
-                LOG_MESSAGE(VAR_in_temp_eva_out_f, temp, source, dest);
-                target->set_indoor_eva_out_temperature(source, temp);
+                auto temp = Temperature::from_tenths(message.value);
+                LOG_MESSAGE(VAR_in_temp_eva_out_f, temp.to_float(), source, dest);
+                target->set_indoor_eva_out_temperature(address, temp);
                 break;
             }
             case MessageNumber::VAR_out_error_code:
@@ -720,35 +761,35 @@ namespace esphome
                 {
                     ESP_LOGW(TAG, "s:%s d:%s VAR_out_error_code %d", source.c_str(), dest.c_str(), code);
                 }
-                target->set_error_code(source, code);
+                target->set_error_code(address, code);
                 break;
             }
             case MessageNumber::LVAR_OUT_CONTROL_WATTMETER_1W_1MIN_SUM:
             {
                 double value = static_cast<double>(message.value);
                 LOG_MESSAGE(LVAR_OUT_CONTROL_WATTMETER_1W_1MIN_SUM, value, source, dest);
-                target->set_outdoor_instantaneous_power(source, value);
+                target->set_outdoor_instantaneous_power(address, value);
                 break;
             }
             case MessageNumber::LVAR_OUT_CONTROL_WATTMETER_ALL_UNIT_ACCUM:
             {
                 double value = static_cast<double>(message.value);
                 LOG_MESSAGE(LVAR_OUT_CONTROL_WATTMETER_ALL_UNIT_ACCUM, value, source, dest);
-                target->set_outdoor_cumulative_energy(source, value);
+                target->set_outdoor_cumulative_energy(address, value);
                 break;
             }
             case MessageNumber::VAR_OUT_SENSOR_CT1:
             {
                 double value = static_cast<double>(message.value);
                 LOG_MESSAGE(VAR_OUT_SENSOR_CT1, value, source, dest);
-                target->set_outdoor_current(source, value);
+                target->set_outdoor_current(address, value);
                 break;
             }
             case MessageNumber::LVAR_NM_OUT_SENSOR_VOLTAGE:
             {
                 double value = static_cast<double>(message.value);
                 LOG_MESSAGE(LVAR_NM_OUT_SENSOR_VOLTAGE, value, source, dest);
-                target->set_outdoor_voltage(source, value);
+                target->set_outdoor_voltage(address, value);
                 break;
             }
             default:
@@ -808,6 +849,102 @@ namespace esphome
             }
         }
 
+        // Settings another controller (wired remote, WiFi kit...) requested from a unit.
+        // They are applied as soon as the unit acknowledges the request, long before
+        // the next notification would report them.
+        struct ForeignRequest
+        {
+            uint8_t packetNumber;
+            Address address; // unit the request was sent to
+            Address sender;
+            uint32_t time;
+            std::vector<std::pair<MessageNumber, long>> values;
+        };
+
+        std::vector<ForeignRequest> foreign_requests;
+
+        // unacknowledged requests of other controllers which are remembered
+        const size_t maxForeignRequests = 8;
+
+        // time a unit has to acknowledge a request of another controller
+        const uint32_t foreignRequestTimeout = 2000;
+
+        bool is_setting_message(MessageNumber messageNumber)
+        {
+            switch (messageNumber)
+            {
+            case MessageNumber::ENUM_in_operation_power:
+            case MessageNumber::ENUM_in_operation_mode:
+            case MessageNumber::ENUM_in_operation_automatic_cleaning:
+            case MessageNumber::ENUM_in_water_heater_power:
+            case MessageNumber::ENUM_in_water_heater_mode:
+            case MessageNumber::ENUM_in_fan_mode:
+            case MessageNumber::ENUM_in_alt_mode:
+            case MessageNumber::ENUM_in_louver_hl_swing:
+            case MessageNumber::ENUM_in_louver_lr_swing:
+            case MessageNumber::VAR_in_temp_target_f:
+            case MessageNumber::VAR_in_temp_water_outlet_target_f:
+            case MessageNumber::VAR_in_temp_water_heater_target_f:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        void remember_foreign_request(MessageTarget *target)
+        {
+            ForeignRequest request;
+            request.packetNumber = packet_.command.packetNumber;
+            request.address = packet_.da;
+            request.sender = packet_.sa;
+            request.time = target->get_miliseconds();
+            for (auto &message : packet_.messages)
+            {
+                if (is_setting_message(message.messageNumber))
+                    request.values.push_back({message.messageNumber, message.value});
+            }
+
+            if (request.values.empty())
+                return;
+
+            foreign_requests.erase(std::remove_if(foreign_requests.begin(), foreign_requests.end(), [&](const ForeignRequest &item)
+                                                  { return request.time - item.time > foreignRequestTimeout; }),
+                                   foreign_requests.end());
+            if (foreign_requests.size() >= maxForeignRequests)
+                foreign_requests.erase(foreign_requests.begin());
+
+            foreign_requests.push_back(std::move(request));
+        }
+
+        // the packet number alone is not unique, every controller counts on its own
+        bool apply_foreign_request(MessageTarget *target)
+        {
+            for (auto it = foreign_requests.begin(); it != foreign_requests.end(); ++it)
+            {
+                if (it->packetNumber != packet_.command.packetNumber || !(it->address == packet_.sa) || !(it->sender == packet_.da))
+                    continue;
+
+                const auto address = it->address.to_string();
+                const auto sender = it->sender.to_string();
+                if (debug_log_messages)
+                {
+                    LOGD("Applying request %d from %s to %s", it->packetNumber, sender.c_str(), address.c_str());
+                }
+
+                for (auto &value : it->values)
+                {
+                    MessageSet message(value.first);
+                    message.value = value.second;
+                    process_messageset(address, sender, it->address.pack(), message, target);
+                }
+
+                foreign_requests.erase(it);
+                return true;
+            }
+
+            return false;
+        }
+
         DecodeResult try_decode_nasa_packet(std::vector<uint8_t> &data)
         {
             return packet_.decode(data);
@@ -817,8 +954,9 @@ namespace esphome
         {
             const auto source = packet_.sa.to_string();
             const auto dest = packet_.da.to_string();
+            const PackedAddress address = packet_.sa.pack();
 
-            target->register_address(source);
+            target->register_address(address);
 
             if (debug_log_undefined_messages)
             {
@@ -827,6 +965,12 @@ namespace esphome
 
             if (packet_.command.dataType == DataType::Ack)
             {
+                apply_foreign_request(target);
+
+                // acks for other controllers can carry the packet number of one of ours
+                if (!(packet_.da == Address::get_my_address()))
+                    return;
+
                 bool ack_found = false;
                 for (auto it = sent_packets.begin(); it != sent_packets.end(); ++it)
                 {
@@ -848,19 +992,28 @@ namespace esphome
                 return;
             }
 
-            if (packet_.command.dataType == DataType::Request)
+            if (packet_.command.dataType == DataType::Request || packet_.command.dataType == DataType::Write)
             {
-                ESP_LOGW(TAG, "Request %s", packet_.to_string().c_str());
+                if (debug_log_messages)
+                {
+                    LOGD("%s %s", packet_.command.dataType == DataType::Write ? "Write" : "Request", packet_.to_string().c_str());
+                }
+
+                // our own requests are tracked by sent_packets
+                if (!(packet_.sa == Address::get_my_address()))
+                    remember_foreign_request(target);
                 return;
             }
             if (packet_.command.dataType == DataType::Response)
             {
-                ESP_LOGW(TAG, "Response %s", packet_.to_string().c_str());
-                return;
-            }
-            if (packet_.command.dataType == DataType::Write)
-            {
-                ESP_LOGW(TAG, "Write %s", packet_.to_string().c_str());
+                // Answers to read requests (from our poll scheduler or other controllers)
+                // carry the current values, so they are handled like notifications.
+                nasa_poll_scheduler.on_response(packet_.command.packetNumber);
+                debug_mqtt_packet(source, dest);
+                for (auto &message : packet_.messages)
+                {
+                    process_messageset(source, dest, address, message, target);
+                }
                 return;
             }
             if (packet_.command.dataType == DataType::Nack)
@@ -870,19 +1023,24 @@ namespace esphome
             }
             if (packet_.command.dataType == DataType::Read)
             {
-                ESP_LOGW(TAG, "Read %s", packet_.to_string().c_str());
+                // reads carry no values, the unit answers them with a response
+                if (debug_log_messages)
+                {
+                    LOGD("Read %s", packet_.to_string().c_str());
+                }
                 return;
             }
 
             if (packet_.command.dataType != DataType::Notification)
                 return;
 
+            debug_mqtt_packet(source, dest);
             for (auto &message : packet_.messages)
             {
-                process_messageset(source, dest, message, target);
+                process_messageset(source, dest, address, message, target);
             }
 
-            uint32_t now = millis();
+            uint32_t now = target->get_miliseconds();
             for (auto &info : sent_packets)
             {
                 if (now - info.last_sent_time > 1000 && info.retry_count < 3)
@@ -1246,9 +1404,180 @@ namespace esphome
             }
         }
 
+        float nasa_poll_bus_utilisation = 0.1f;
+
+        NasaPollScheduler nasa_poll_scheduler;
+
+        // 11 bits per byte (8E1) at 9600 baud
+        const uint32_t NASA_BYTE_TIME_US = 1146;
+
+        // message sets per read packet, keeps the request and its response short
+        const uint8_t NASA_POLL_MAX_MESSAGES = 10;
+
+        // start byte, size, addresses, command, capacity, crc and end byte of a packet
+        const uint32_t NASA_PACKET_OVERHEAD_BYTES = 16;
+
+        // largest read packet (long variables only)
+        const uint32_t NASA_POLL_MAX_PACKET_BYTES = NASA_PACKET_OVERHEAD_BYTES + NASA_POLL_MAX_MESSAGES * 6;
+
+        // encoded size of a message set in a read packet, the value is 0 so structures are empty
+        static uint32_t read_message_bytes(MessageNumber messageNumber)
+        {
+            switch (MessageSet(messageNumber).type)
+            {
+            case Enum:
+                return 3;
+            case Variable:
+                return 4;
+            case LongVariable:
+                return 6;
+            default:
+                return 2;
+            }
+        }
+
+        // time to wait for the response before the next read request is sent
+        const uint32_t NASA_POLL_RESPONSE_TIMEOUT_MS = 1000;
+
+        void NasaPollScheduler::add(const Address &address, MessageNumber messageNumber, uint32_t interval)
+        {
+            if (MessageSet(messageNumber).type == Structure)
+            {
+                LOGW("Structure message %s can not be polled", long_to_hex((uint16_t)messageNumber).c_str());
+                return;
+            }
+
+            entries_.push_back({address, messageNumber, interval, 0});
+        }
+
+        void NasaPollScheduler::add_once(const Address &address, MessageNumber messageNumber)
+        {
+            for (auto &entry : entries_)
+            {
+                if (entry.address == address && entry.messageNumber == messageNumber)
+                    return; // already scheduled
+            }
+
+            add(address, messageNumber, 0);
+        }
+
+        void NasaPollScheduler::on_response(uint8_t packetNumber)
+        {
+            if (awaiting_response_ && awaiting_packet_number_ == packetNumber)
+                awaiting_response_ = false;
+        }
+
+        void NasaPollScheduler::update(MessageTarget *target)
+        {
+            if (entries_.empty())
+                return;
+
+            const uint32_t now = target->get_miliseconds();
+
+            // Accumulate bus time credit. The credit is capped so that a long idle
+            // period does not allow a burst of read requests afterwards.
+            const uint32_t elapsed = std::min<uint32_t>(now - last_update_, 10000);
+            last_update_ = now;
+            credit_us_ = std::min<uint32_t>(2 * NASA_POLL_MAX_PACKET_BYTES * NASA_BYTE_TIME_US,
+                                            credit_us_ + (uint32_t)(elapsed * 1000 * nasa_poll_bus_utilisation));
+
+            if (awaiting_response_)
+            {
+                if (now - awaiting_since_ < NASA_POLL_RESPONSE_TIMEOUT_MS)
+                    return;
+
+                LOGD("No response for poll packet %d", awaiting_packet_number_);
+                awaiting_response_ = false;
+            }
+
+            // find the next due entry, starting behind the one served last
+            const size_t count = entries_.size();
+            size_t first = count;
+            for (size_t i = 0; i < count; i++)
+            {
+                const size_t index = (cursor_ + i) % count;
+                if ((int32_t)(now - entries_[index].next_poll) >= 0)
+                {
+                    first = index;
+                    break;
+                }
+            }
+
+            if (first == count)
+                return;
+
+            // pack all due messages of the same address into one read packet
+            const Address address = entries_[first].address;
+            size_t polled[NASA_POLL_MAX_MESSAGES];
+            size_t polled_count = 0;
+            uint32_t bytes = NASA_PACKET_OVERHEAD_BYTES;
+            for (size_t i = 0; i < count && polled_count < NASA_POLL_MAX_MESSAGES; i++)
+            {
+                const size_t index = (first + i) % count;
+                auto &entry = entries_[index];
+                if (!(entry.address == address) || (int32_t)(now - entry.next_poll) < 0)
+                    continue;
+
+                bytes += read_message_bytes(entry.messageNumber);
+                polled[polled_count++] = index;
+            }
+
+            // the response has the same layout as the request, so both are accounted.
+            // Checked before the packet is built, so waiting for credit uses no packet number.
+            const uint32_t cost_us = 2 * bytes * NASA_BYTE_TIME_US;
+            if (credit_us_ < cost_us)
+                return;
+            credit_us_ -= cost_us;
+
+            Packet packet = Packet::createa_partial(address, DataType::Read);
+            for (size_t i = 0; i < polled_count; i++)
+            {
+                MessageSet message(entries_[polled[i]].messageNumber);
+                message.value = 0;
+                packet.messages.push_back(message);
+            }
+            auto data = packet.encode();
+
+            for (size_t i = 0; i < polled_count; i++)
+            {
+                entries_[polled[i]].next_poll = now + entries_[polled[i]].interval;
+            }
+            cursor_ = (first + 1) % count;
+
+            // drop one-shot reads, back to front so the collected indexes stay valid
+            std::sort(polled, polled + polled_count);
+            for (size_t i = polled_count; i-- > 0;)
+            {
+                if (entries_[polled[i]].interval == 0)
+                    entries_.erase(entries_.begin() + polled[i]);
+            }
+            if (!entries_.empty())
+                cursor_ %= entries_.size();
+
+            if (debug_log_messages)
+            {
+                LOGD("poll %s", packet.to_string().c_str());
+            }
+
+            awaiting_response_ = true;
+            awaiting_packet_number_ = packet.command.packetNumber;
+            awaiting_since_ = now;
+            target->publish_data(0, std::move(data));
+        }
+
+        void NasaProtocol::add_poll_message(const std::string &address, uint16_t message_number, uint32_t interval)
+        {
+            nasa_poll_scheduler.add(Address::parse(address), (MessageNumber)message_number, interval);
+        }
+
+        void NasaProtocol::request_read(const std::string &address, uint16_t message_number)
+        {
+            nasa_poll_scheduler.add_once(Address::parse(address), (MessageNumber)message_number);
+        }
+
         void NasaProtocol::protocol_update(MessageTarget *target)
         {
-            // Unused for NASA protocol
+            nasa_poll_scheduler.update(target);
         }
 
     } // namespace samsung_ac
@@ -109,6 +109,16 @@ namespace esphome
             void decode(std::vector<uint8_t> &data, unsigned int index);
             void encode(std::vector<uint8_t> &data);
             std::string to_string();
+
+            PackedAddress pack() const
+            {
+                return (PackedAddress)klass << 16 | (PackedAddress)channel << 8 | address;
+            }
+
+            bool operator==(const Address &other) const
+            {
+                return klass == other.klass && channel == other.channel && address == other.address;
+            }
         };
 
         struct Command
@@ -176,13 +186,49 @@ namespace esphome
         DecodeResult try_decode_nasa_packet(std::vector<uint8_t> &data);
         void process_nasa_packet(MessageTarget *target);
 
+        struct NasaPollEntry
+        {
+            Address address;
+            MessageNumber messageNumber;
+            uint32_t interval; // 0 = read only once
+            uint32_t next_poll;
+        };
+
+        // Polls messages which are never broadcast by the units. Due messages for the
+        // same address are packed into one Read packet, addresses are served round-robin
+        // and the resulting bus traffic is limited by nasa_poll_bus_utilisation.
+        class NasaPollScheduler
+        {
+        public:
+            void add(const Address &address, MessageNumber messageNumber, uint32_t interval);
+            void add_once(const Address &address, MessageNumber messageNumber);
+            void update(MessageTarget *target);
+            void on_response(uint8_t packetNumber);
+
+            bool empty() { return entries_.empty(); }
+
+        protected:
+            std::vector<NasaPollEntry> entries_;
+            size_t cursor_ = 0;
+            uint32_t credit_us_ = 0;
+            uint32_t last_update_ = 0;
+            bool awaiting_response_ = false;
+            uint8_t awaiting_packet_number_ = 0;
+            uint32_t awaiting_since_ = 0;
+        };
+
+        extern NasaPollScheduler nasa_poll_scheduler;
+
         class NasaProtocol : public Protocol
         {
         public:
             NasaProtocol() = default;
 
             void publish_request(MessageTarget *target, const std::string &address, ProtocolRequest &request) override;
+            void publish_group_request(MessageTarget *target, const std::vector<std::string> &addresses, ProtocolRequest &request, bool broadcast) override;
             void protocol_update(MessageTarget *target) override;
+            void add_poll_message(const std::string &address, uint16_t message_number, uint32_t interval) override;
+            void request_read(const std::string &address, uint16_t message_number) override;
         protected:
             std::map<std::string, ProtocolRequest> outgoing_queue_; // std::string address -> ProtocolRequest
         };
@@ -6,6 +6,7 @@
 #include "esphome/core/hal.h"
 #include "util.h"
 #include "protocol_non_nasa.h"
+#include "frame.h"
 
 std::map<std::string, esphome::samsung_ac::NonNasaCommand20> last_command20s_;
 
@@ -15,10 +16,13 @@ namespace esphome
 {
     namespace samsung_ac
     {
-        std::list<NonNasaRequestQueueItem> nonnasa_requests;
+        std::array<NonNasaRequestQueueItem, NONNASA_REQUEST_SLOTS> nonnasa_requests;
         bool controller_registered = false;
         bool indoor_unit_awake = true;
 
+        // Time of the last message from an indoor unit. A unit which sends is not sleeping.
+        uint32_t last_indoor_packet = 0;
+
         // Timestamp of the last time we attempted controller registration. Used to
         // slow down repeated registration attempts so we don't spam the outdoor unit.
         uint32_t last_register_attempt = 0;
@@ -28,14 +32,39 @@ namespace esphome
 
         uint8_t build_checksum(std::vector<uint8_t> &data)
         {
-            uint8_t sum = data[1];
-            for (uint8_t i = 2; i < 12; i++)
-            {
-                sum = sum ^ data[i];
-            }
-            return sum;
+            return frame_checksum(data.data());
+        }
+
+        NonNasaFrame::NonNasaFrame(uint8_t src, uint8_t dst, uint8_t cmd)
+            : data{0x32, src, dst, cmd, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x34}
+        {
+            data[12] = src ^ dst ^ cmd;
+        }
+
+        NonNasaFrame make_control_frame()
+        {
+            NonNasaFrame frame(0xD0, 0x00, 0xB0);
+            frame.set(4, 0x1F);
+            frame.set(5, 0x04);
+            frame.set(9, 0x21);
+            return frame;
         }
 
+        NonNasaFrame make_register_frame()
+        {
+            // Registers our device as a "controller" with the outdoor unit. This will cause the
+            // outdoor unit to poll us with a request_control message approximately every second,
+            // which we can reply to with a control message if required.
+            NonNasaFrame frame(0xD0, 0xC8, 0xD1); // cmd register_device
+            frame.set(4, 0xD2);                   // device_type controller
+            return frame;
+        }
+
+        // control frame without destination and settings, patched for each request
+        const NonNasaFrame control_frame = make_control_frame();
+
+        const NonNasaFrame register_frame = make_register_frame();
+
         std::string NonNasaCommand20::to_string()
         {
             std::string str;
@@ -185,6 +214,7 @@ namespace esphome
 
             src = long_to_hex(data[1]);
             dst = long_to_hex(data[2]);
+            packed_src = nonNasaAddressFlag | data[1];
 
             cmd = (NonNasaCommand)data[3];
             switch (cmd)
@@ -316,41 +346,25 @@ namespace esphome
             }
         }
 
-        std::vector<uint8_t> NonNasaRequest::encode()
+        NonNasaFrame NonNasaRequest::encode_frame() const
         {
-            std::vector<uint8_t> data{
-                0x32,                     // 00 start
-                0xD0,                     // 01 src
-                (uint8_t)hex_to_int(dst), // 02 dst
-                0xB0,                     // 03 cmd
-                0x1F,                     // 04 ?
-                0x04,                     // 05 ?
-                0,                        // 06 temp + fanmode
-                0,                        // 07 operation mode
-                0,                        // 08 power + individual mode
-                0,                        // 09
-                0,                        // 10
-                0,                        // 11
-                0,                        // 12 crc
-                0x34                      // 13 end
-            };
-
             // individual seems to deactivate the locale remotes with message "CENTRAL".
             // seems to be like a building management system.
             bool individual = false;
 
+            NonNasaFrame frame = control_frame;
+            frame.set(2, (uint8_t)hex_to_int(dst));
             if (room_temp > 0)
-                data[5] = room_temp;
-            data[6] = (target_temp & 31U) | encode_request_fanspeed(fanspeed);
-            data[7] = (uint8_t)encode_request_mode(mode);
-            data[8] = !power ? (uint8_t)0xC0 : (uint8_t)0xF0;
-            data[8] |= (individual ? 6U : 4U);
-            data[9] = (uint8_t)0x21;
-            data[12] = build_checksum(data);
-
-            data[9] = (uint8_t)0x21;
+                frame.set(5, room_temp);
+            frame.set(6, (target_temp & 31U) | encode_request_fanspeed(fanspeed));
+            frame.set(7, encode_request_mode(mode));
+            frame.set(8, (!power ? 0xC0U : 0xF0U) | (individual ? 6U : 4U));
+            return frame;
+        }
 
-            return data;
+        std::vector<uint8_t> NonNasaRequest::encode() const
+        {
+            return encode_frame().to_vector();
         }
 
         NonNasaRequest NonNasaRequest::create(std::string dst_address)
@@ -403,9 +417,37 @@ namespace esphome
             }
         }
 
+        NonNasaRequestQueueItem *find_request_slot(const std::string &address)
+        {
+            for (auto &item : nonnasa_requests)
+            {
+                if (item.active && item.request.dst == address)
+                    return &item;
+            }
+            return nullptr;
+        }
+
+        NonNasaRequestQueueItem &allocate_request_slot()
+        {
+            NonNasaRequestQueueItem *oldest = &nonnasa_requests[0];
+            for (auto &item : nonnasa_requests)
+            {
+                if (!item.active)
+                    return item;
+                if (item.time < oldest->time)
+                    oldest = &item;
+            }
+
+            // there are less units than slots on any known NonNASA system, so this is only a safety net
+            LOGW("NonNASA request queue full, dropping the oldest request for %s", oldest->request.dst.c_str());
+            return *oldest;
+        }
+
         void NonNasaProtocol::publish_request(MessageTarget *target, const std::string &address, ProtocolRequest &request)
         {
-            auto req = NonNasaRequest::create(address);
+            // changes are merged into a request which is still pending, the latest value wins
+            NonNasaRequestQueueItem *slot = find_request_slot(address);
+            auto req = slot != nullptr ? slot->request : NonNasaRequest::create(address);
 
             if (request.mode)
             {
@@ -432,19 +474,28 @@ namespace esphome
                 LOGW("change swingmode is currently not implemented");
             }
 
-            // Add to the queue with the current time
-            NonNasaRequestQueueItem reqItem = NonNasaRequestQueueItem();
-            reqItem.request = req;
-            reqItem.time = millis();
-            reqItem.time_sent = 0;
-            reqItem.retry_count = 0;
-            reqItem.resend_count = 0;
+            if (slot == nullptr)
+                slot = &allocate_request_slot();
 
-            // Safety check the length of the queue (in case something is spamming control
-            // requests we don't want the queue to get too large).
-            if (nonnasa_requests.size() < 10)
+            // (re)queue with the current time, a request which was already sent is sent again
+            // with the merged state in the next request_control window
+            slot->active = true;
+            slot->request = req;
+            slot->frame = req.encode_frame();
+            slot->time = target->get_miliseconds();
+            slot->time_sent = 0;
+            slot->retry_count = 0;
+            slot->resend_count = 0;
+        }
+
+        void NonNasaProtocol::publish_group_request(MessageTarget *target, const std::vector<std::string> &addresses, ProtocolRequest &request, bool broadcast)
+        {
+            // every frame carries the complete state of one unit, so there is no broadcast.
+            // the queued requests are all sent in the next request_control window.
+            for (const auto &address : addresses)
             {
-                nonnasa_requests.push_back(reqItem);
+                ProtocolRequest unit_request = request;
+                publish_request(target, address, unit_request);
             }
         }
 
@@ -502,13 +553,13 @@ namespace esphome
 
         void send_requests(MessageTarget *target)
         {
-            const uint32_t now = millis();
+            const uint32_t now = target->get_miliseconds();
             for (auto &item : nonnasa_requests)
             {
-                if (item.time_sent == 0)
+                if (item.active && item.time_sent == 0)
                 {
                     item.time_sent = now;
-                    target->publish_data(0, item.request.encode());
+                    target->publish_data(0, item.frame.to_vector());
                 }
             }
         }
@@ -517,30 +568,9 @@ namespace esphome
         {
             LOGD("Sending controller registration request...");
 
-            // Registers our device as a "controller" with the outdoor unit. This will cause the
-            // outdoor unit to poll us with a request_control message approximately every second,
-            // which we can reply to with a control message if required.
-            std::vector<uint8_t> data{
-                0x32, // 00 start
-                0xD0, // 01 src
-                0xc8, // 02 dst
-                0xD1, // 03 cmd (register_device)
-                0xD2, // 04 device_type (controller)
-                0,    // 05
-                0,    // 06
-                0,    // 07
-                0,    // 08
-                0,    // 09
-                0,    // 10
-                0,    // 11
-                0,    // 12 crc
-                0x34  // 13 end
-            };
-            data[12] = build_checksum(data);
-
             // Send now
-            last_register_attempt = millis();
-            target->publish_data(0, std::move(data));
+            last_register_attempt = target->get_miliseconds();
+            target->publish_data(0, register_frame.to_vector());
         }
 
         void process_non_nasa_packet(MessageTarget *target)
@@ -550,11 +580,12 @@ namespace esphome
                 LOG_PACKET_RECV("RECV", nonpacket_);
             }
 
-            target->register_address(nonpacket_.src);
+            target->register_address(nonpacket_.packed_src);
 
             // Check if we have a message from the indoor unit. If so, we can assume it is awake.
-            if (!indoor_unit_awake && get_address_type(nonpacket_.src) == AddressType::Indoor)
+            if (get_address_type(nonpacket_.src) == AddressType::Indoor)
             {
+                last_indoor_packet = target->get_miliseconds();
                 indoor_unit_awake = true;
             }
 
@@ -564,48 +595,42 @@ namespace esphome
                 // packet, so as a backup approach check if the state of the device matches that of the
                 // sent control packet. This also serves as a backup approach if for some reason a device
                 // doesn't send control_acknowledgement messages at all.
-                nonnasa_requests.remove_if([&](const NonNasaRequestQueueItem &item)
-                                           { return item.time_sent > 0 &&
-                                                    nonpacket_.src == item.request.dst &&
-                                                    item.request.target_temp == nonpacket_.command20.target_temp &&
-                                                    item.request.fanspeed == nonpacket_.command20.fanspeed &&
-                                                    item.request.mode == nonpacket_.command20.mode &&
-                                                    item.request.power == nonpacket_.command20.power; });
+                NonNasaRequestQueueItem *slot = find_request_slot(nonpacket_.src);
+                if (slot != nullptr && slot->time_sent > 0 &&
+                    slot->request.target_temp == nonpacket_.command20.target_temp &&
+                    slot->request.fanspeed == nonpacket_.command20.fanspeed &&
+                    slot->request.mode == nonpacket_.command20.mode &&
+                    slot->request.power == nonpacket_.command20.power)
+                {
+                    slot->active = false;
+                }
 
                 // If a state update comes through after a control message has been sent, but before it
                 // has been acknowledged, it should be ignored. This prevents the UI status bouncing
                 // between states after a command has been issued.
-                bool pending_control_message = false;
-                for (auto& item : nonnasa_requests)
-                {
-                   if (item.time_sent > 0 && nonpacket_.src == item.request.dst)
-                   {
-                      pending_control_message = true;
-                      break;
-                   }
-                }
+                bool pending_control_message = slot != nullptr && slot->active && slot->time_sent > 0;
 
                 if (!pending_control_message)
                 {
                    last_command20s_[nonpacket_.src] = nonpacket_.command20;
-                   target->set_target_temperature(nonpacket_.src, nonpacket_.command20.target_temp);
+                   target->set_target_temperature(nonpacket_.packed_src, Temperature::from_degrees(nonpacket_.command20.target_temp));
                    // TODO
-                   target->set_water_outlet_target(nonpacket_.src, false);
+                   target->set_water_outlet_target(nonpacket_.packed_src, Temperature::from_degrees(0));
                    // TODO
-                   target->set_target_water_temperature(nonpacket_.src, false);
-                   target->set_room_temperature(nonpacket_.src, nonpacket_.command20.room_temp);
-                   target->set_power(nonpacket_.src, nonpacket_.command20.power);
+                   target->set_target_water_temperature(nonpacket_.packed_src, Temperature::from_degrees(0));
+                   target->set_room_temperature(nonpacket_.packed_src, Temperature::from_degrees(nonpacket_.command20.room_temp));
+                   target->set_power(nonpacket_.packed_src, nonpacket_.command20.power);
                    // TODO
-                   target->set_water_heater_power(nonpacket_.src, false);
-                   target->set_mode(nonpacket_.src, nonnasa_mode_to_mode(nonpacket_.command20.mode));
+                   target->set_water_heater_power(nonpacket_.packed_src, false);
+                   target->set_mode(nonpacket_.packed_src, nonnasa_mode_to_mode(nonpacket_.command20.mode));
                    // TODO
-				   target->set_water_heater_mode(nonpacket_.src, nonnasa_water_heater_mode_to_mode(-0));
-                   target->set_fanmode(nonpacket_.src, nonnasa_fanspeed_to_fanmode(nonpacket_.command20.fanspeed));
+				   target->set_water_heater_mode(nonpacket_.packed_src, nonnasa_water_heater_mode_to_mode(-0));
+                   target->set_fanmode(nonpacket_.packed_src, nonnasa_fanspeed_to_fanmode(nonpacket_.command20.fanspeed));
                    // TODO
-                   target->set_altmode(nonpacket_.src, 0);
+                   target->set_altmode(nonpacket_.packed_src, 0);
                    // TODO
-                   target->set_swing_horizontal(nonpacket_.src, false);
-                   target->set_swing_vertical(nonpacket_.src, false);
+                   target->set_swing_horizontal(nonpacket_.packed_src, false);
+                   target->set_swing_vertical(nonpacket_.packed_src, false);
                 }
             }
             else if (nonpacket_.cmd == NonNasaCommand::CmdC6)
@@ -620,7 +645,7 @@ namespace esphome
                         LOGD("Controller registered");
                         controller_registered = true;
                     }
-                    if (indoor_unit_awake)
+                    if (indoor_unit_awake && !passive_mode)
                     {
                         // We know the outdoor unit is awake due to this request_control message, so we only
                         // need to check that the indoor unit is awake.
@@ -634,8 +659,9 @@ namespace esphome
                 // indoor unit in reply to a control message from us, allowing us to confirm the control
                 // message was successfully sent. The data portion contains the same data we sent (however
                 // we can just assume it's for any sent packet, rather than comparing).
-                nonnasa_requests.remove_if([&](const NonNasaRequestQueueItem &item)
-                                           { return item.time_sent > 0 && nonpacket_.src == item.request.dst; });
+                NonNasaRequestQueueItem *slot = find_request_slot(nonpacket_.src);
+                if (slot != nullptr && slot->time_sent > 0)
+                    slot->active = false;
             }
             else if (nonpacket_.src == "c8" && nonpacket_.dst == "ad" && (nonpacket_.commandRaw.data[0] & 1) == 1)
             {
@@ -643,9 +669,9 @@ namespace esphome
                 // more than once, however we can use this as a keepalive method. A 30ms delay is added
                 // to allow other controllers to register. This mimics SNET Pro behaviour.
                 // It's unknown why the first data byte must be odd.
-                if (non_nasa_keepalive)
+                if (non_nasa_keepalive && !passive_mode)
                 {
-                    const uint32_t now = millis();
+                    const uint32_t now = target->get_miliseconds();
                     if (now - last_register_attempt > NONNASA_REGISTER_INTERVAL_MS)
                     {
                         delay(30);
@@ -655,13 +681,23 @@ namespace esphome
             }
         }
 
+        void NonNasaProtocol::add_poll_message(const std::string &address, uint16_t message_number, uint32_t interval)
+        {
+            LOGW("polling messages is not supported by NonNASA devices (%s)", address.c_str());
+        }
+
+        void NonNasaProtocol::request_read(const std::string &address, uint16_t message_number)
+        {
+            // NonNASA indoor units send their complete state periodically, nothing to request
+        }
+
         void NonNasaProtocol::protocol_update(MessageTarget *target)
         {
             // If we're not currently registered, send a registration request only at a
             // limited rate so we don't flood the outdoor unit.
             if (!controller_registered)
             {
-                const uint32_t now = millis();
+                const uint32_t now = target->get_miliseconds();
                 if (now - last_register_attempt > NONNASA_REGISTER_INTERVAL_MS)
                 {
                     send_register_controller(target);
@@ -670,16 +706,19 @@ namespace esphome
 
             // If we have *any* messages in the queue for longer than 15s, assume failure and
             // remove from queue (the AC or UART connection is likely offline).
-            const uint32_t now = millis();
-            nonnasa_requests.remove_if([&](const NonNasaRequestQueueItem &item)
-                                       { return now - item.time > 15000; });
+            const uint32_t now = target->get_miliseconds();
+            for (auto &item : nonnasa_requests)
+            {
+                if (item.active && now - item.time > 15000)
+                    item.active = false;
+            }
 
             // If we have any *sent* messages in the queue that haven't received an ack in under 5s,
             // assume they failed and queue for resend on the next request_control message. Retry at
             // most 3 times.
             for (auto &item : nonnasa_requests)
             {
-                if (item.time_sent > 0 && item.resend_count < 3 && now - item.time_sent > 4500)
+                if (item.active && item.time_sent > 0 && item.resend_count < 3 && now - item.time_sent > 4500)
                 {
                     item.time_sent = 0; // Resend
                     item.resend_count++;
@@ -688,10 +727,12 @@ namespace esphome
 
             // If we have any *unsent* messages in the queue for over 1000ms, it likely means the indoor
             // and/or outdoor unit has gone to sleep due to inactivity. Send a registration request to
-            // wake the unit up.
+            // wake the unit up. An indoor unit which sent something meanwhile is awake, the request only
+            // missed a request_control message (e.g. a collision), it is sent with the next one.
             for (auto &item : nonnasa_requests)
             {
-                    if (item.time_sent == 0 && now - item.time > 1000 && item.resend_count == 0 && item.retry_count == 0)
+                    if (item.active && item.time_sent == 0 && now - item.time > 1000 && now - last_indoor_packet > 1000 &&
+                        item.resend_count == 0 && item.retry_count == 0)
                     {
                         // Both the outdoor and the indoor unit must be awake before we can send a command
                         indoor_unit_awake = false;
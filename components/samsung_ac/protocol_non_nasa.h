@@ -1,6 +1,6 @@
 #pragma once
 
-#include <list>
+#include <array>
 #include <vector>
 #include <optional>
 #include "protocol.h"
@@ -149,6 +149,7 @@ namespace esphome
         {
             std::string src;
             std::string dst;
+            PackedAddress packed_src; // src for the MessageTarget
 
             NonNasaCommand cmd;
 
@@ -174,6 +175,27 @@ namespace esphome
             std::string to_string();
         };
 
+        // A complete NonNASA frame. Fields are patched in place and the checksum is
+        // updated with each patch, so a frame can be copied and resent as is.
+        struct NonNasaFrame
+        {
+            std::array<uint8_t, 14> data{};
+
+            NonNasaFrame() = default;
+            NonNasaFrame(uint8_t src, uint8_t dst, uint8_t cmd);
+
+            void set(uint8_t index, uint8_t value)
+            {
+                data[12] ^= data[index] ^ value;
+                data[index] = value;
+            }
+
+            std::vector<uint8_t> to_vector() const
+            {
+                return std::vector<uint8_t>(data.begin(), data.end());
+            }
+        };
+
         struct NonNasaRequest
         {
             std::string dst;
@@ -184,22 +206,29 @@ namespace esphome
             NonNasaMode mode = NonNasaMode::Heat;
             bool power = false;
 
-            std::vector<uint8_t> encode();
+            NonNasaFrame encode_frame() const;
+            std::vector<uint8_t> encode() const;
             std::string to_string();
 
             static NonNasaRequest create(std::string dst_address);
         };
 
+        // pending request for one unit. A newer request for the same unit is merged into it,
+        // so only the latest state is sent.
         struct NonNasaRequestQueueItem
         {
+            bool active = false;
             NonNasaRequest request;
-            uint32_t time;
-            uint32_t time_sent;
-            uint8_t retry_count;
-            uint8_t resend_count;
+            NonNasaFrame frame;
+            uint32_t time = 0;
+            uint32_t time_sent = 0;
+            uint8_t retry_count = 0;
+            uint8_t resend_count = 0;
         };
 
-        extern std::list<NonNasaRequestQueueItem> nonnasa_requests;
+        const size_t NONNASA_REQUEST_SLOTS = 16;
+
+        extern std::array<NonNasaRequestQueueItem, NONNASA_REQUEST_SLOTS> nonnasa_requests;
         extern bool controller_registered;
         extern bool indoor_unit_awake;
 
@@ -212,7 +241,10 @@ namespace esphome
             NonNasaProtocol() = default;
 
             void publish_request(MessageTarget *target, const std::string &address, ProtocolRequest &request) override;
+            void publish_group_request(MessageTarget *target, const std::vector<std::string> &addresses, ProtocolRequest &request, bool broadcast) override;
             void protocol_update(MessageTarget *target) override;
+            void add_poll_message(const std::string &address, uint16_t message_number, uint32_t interval) override;
+            void request_read(const std::string &address, uint16_t message_number) override;
         };
     } // namespace samsung_ac
 } // namespace esphome
@@ -0,0 +1,94 @@
+#include "esphome/core/log.h"
+#include "raw_stream.h"
+#include "util.h"
+
+namespace esphome
+{
+    namespace samsung_ac
+    {
+        void RawStream::setup(uint16_t port)
+        {
+            server_ = socket::socket_ip(SOCK_STREAM, 0);
+            if (server_ == nullptr)
+            {
+                ESP_LOGW(TAG, "Could not create raw stream socket");
+                return;
+            }
+
+            int enable = 1;
+            server_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(int));
+            server_->setblocking(false);
+
+            struct sockaddr_storage server;
+            socklen_t sl = socket::set_sockaddr_any((struct sockaddr *)&server, sizeof(server), port);
+            if (sl == 0 || server_->bind((struct sockaddr *)&server, sl) != 0 || server_->listen(1) != 0)
+            {
+                ESP_LOGW(TAG, "Could not listen for raw stream clients on port %u", port);
+                server_ = nullptr;
+                return;
+            }
+
+            buffer_.reserve(rawStreamBufferSize);
+            ESP_LOGCONFIG(TAG, "Raw stream listening on port %u", port);
+        }
+
+        void RawStream::loop(uint32_t now)
+        {
+            if (server_ == nullptr)
+                return;
+
+            struct sockaddr_storage source;
+            socklen_t addr_len = sizeof(source);
+            auto client = server_->accept((struct sockaddr *)&source, &addr_len);
+            if (client != nullptr)
+            {
+                // a new client replaces the old one, e.g. after the receiver was restarted
+                client->setblocking(false);
+                client_ = std::move(client);
+                buffer_.clear();
+                append_capture_header(buffer_);
+                reported_dropped_ = dropped_;
+                ESP_LOGD(TAG, "Raw stream client connected");
+            }
+
+            if (client_ == nullptr)
+                return;
+
+            if (reported_dropped_ != dropped_ && buffer_.size() + captureRecordHeaderSize + 4 <= rawStreamBufferSize)
+            {
+                append_capture_dropped(buffer_, now, dropped_);
+                reported_dropped_ = dropped_;
+            }
+
+            if (buffer_.empty())
+                return;
+
+            ssize_t written = client_->write(buffer_.data(), buffer_.size());
+            if (written < 0)
+            {
+                if (errno == EWOULDBLOCK || errno == EAGAIN)
+                    return;
+                ESP_LOGD(TAG, "Raw stream client disconnected");
+                client_ = nullptr;
+                buffer_.clear();
+                return;
+            }
+
+            buffer_.erase(buffer_.begin(), buffer_.begin() + written);
+        }
+
+        void RawStream::add(uint32_t time, CaptureDirection direction, const uint8_t *data, size_t length)
+        {
+            if (client_ == nullptr)
+                return;
+
+            if (buffer_.size() + captureRecordHeaderSize + length > rawStreamBufferSize)
+            {
+                dropped_++;
+                return;
+            }
+
+            append_capture_record(buffer_, time, direction, data, length);
+        }
+    } // namespace samsung_ac
+} // namespace esphome
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "esphome/components/socket/socket.h"
+#include "capture.h"
+
+namespace esphome
+{
+    namespace samsung_ac
+    {
+        // frames which do not fit are dropped (and counted) until the client caught up
+        const size_t rawStreamBufferSize = 4096;
+
+        // TCP server which streams all raw frames to one client in the capture format (see capture.h)
+        class RawStream
+        {
+        public:
+            void setup(uint16_t port);
+            void loop(uint32_t now);
+            void add(uint32_t time, CaptureDirection direction, const uint8_t *data, size_t length);
+
+            bool is_connected() const
+            {
+                return client_ != nullptr;
+            }
+
+            uint32_t dropped() const
+            {
+                return dropped_;
+            }
+
+        protected:
+            std::unique_ptr<socket::Socket> server_;
+            std::unique_ptr<socket::Socket> client_;
+            std::vector<uint8_t> buffer_;
+            uint32_t dropped_ = 0;
+            uint32_t reported_dropped_ = 0;
+        };
+    } // namespace samsung_ac
+} // namespace esphome
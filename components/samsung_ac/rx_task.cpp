@@ -0,0 +1,137 @@
+#include "esphome/core/hal.h"
+#include "rx_task.h"
+#include "frame.h"
+
+namespace esphome
+{
+    namespace samsung_ac
+    {
+        bool RxTask::start(uart::UARTDevice *uart)
+        {
+            if (is_running())
+                return true;
+
+            uart_ = uart;
+            running_.store(true);
+#if defined(USE_ESP32)
+            finished_.store(false);
+            if (xTaskCreate([](void *arg)
+                            {
+                                static_cast<RxTask *>(arg)->run();
+                                vTaskDelete(nullptr); },
+                            "samsung_ac_rx", 4096, this, rxTaskPriority, nullptr) == pdPASS)
+                return true;
+#elif !defined(USE_ESP8266)
+            if (pthread_create(&thread_, nullptr, [](void *arg) -> void *
+                               {
+                                   static_cast<RxTask *>(arg)->run();
+                                   return nullptr; },
+                               this) == 0)
+                return true;
+#endif
+            running_.store(false);
+            return false;
+        }
+
+        void RxTask::stop()
+        {
+            if (!is_running())
+                return;
+
+            running_.store(false);
+#if defined(USE_ESP32)
+            while (!finished_.load())
+                delay(1);
+#elif !defined(USE_ESP8266)
+            pthread_join(thread_, nullptr);
+#endif
+        }
+
+        void RxTask::run()
+        {
+            while (running_.load(std::memory_order_relaxed))
+            {
+                poll(uart_, millis());
+                // a byte takes about 1 ms at 9600 baud, the UART buffers far more than that
+                delay(1);
+            }
+#if defined(USE_ESP32)
+            finished_.store(true);
+#endif
+        }
+
+        void RxTask::poll(uart::UARTDevice *uart, uint32_t now)
+        {
+            uint8_t buffer[64];
+            bool received = false;
+            int available;
+            while ((available = uart->available()) > 0)
+            {
+                const size_t length = std::min((size_t)available, sizeof(buffer));
+                if (!uart->read_array(buffer, length))
+                    break;
+                data_.insert(data_.end(), buffer, buffer + length);
+                received = true;
+            }
+
+            if (received)
+            {
+                last_byte_ = now;
+                last_activity_.store(now, std::memory_order_relaxed);
+            }
+
+            bool pushed = false;
+            while (!data_.empty())
+            {
+                int length = frame_length(data_.data(), data_.size());
+                if (length == 0)
+                {
+                    if (now - last_byte_ < rxFrameTimeout)
+                        break;
+                    // the frame will not be completed anymore, the rest might still hold one
+                    length = -(int)next_frame_start(data_.data(), data_.size(), 1);
+                }
+
+                const size_t bytes = length > 0 ? length : -length;
+                push(now, length > 0 ? CaptureDirection::Received : CaptureDirection::Discarded, bytes);
+                data_.erase(data_.begin(), data_.begin() + bytes);
+                pushed = true;
+            }
+
+            // frames of one pass become visible together
+            if (pushed)
+                ring_.commit();
+            receiving_.store(!data_.empty(), std::memory_order_relaxed);
+        }
+
+        void RxTask::push(uint32_t time, CaptureDirection direction, size_t length)
+        {
+            if (ring_.writable() < captureRecordHeaderSize + length)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            const uint8_t header[captureRecordHeaderSize] = {(uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24),
+                                                             (uint8_t)direction, (uint8_t)length, (uint8_t)(length >> 8)};
+            ring_.write(header, sizeof(header));
+            ring_.write(data_.data(), length);
+        }
+
+        bool RxTask::pop(uint32_t &time, CaptureDirection &direction, std::vector<uint8_t> &data)
+        {
+            if (ring_.readable() < captureRecordHeaderSize)
+                return false;
+
+            uint8_t header[captureRecordHeaderSize];
+            ring_.read(header, sizeof(header));
+            time = read_capture_le(header, 4);
+            direction = (CaptureDirection)header[4];
+            data.resize(read_capture_le(header + 5, 2));
+            // records are committed as a whole
+            ring_.read(data.data(), data.size());
+            ring_.release();
+            return true;
+        }
+    } // namespace samsung_ac
+} // namespace esphome
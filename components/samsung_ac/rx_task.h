@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "esphome/components/uart/uart.h"
+#include "capture.h"
+#include "spsc_ring.h"
+
+#if defined(USE_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#elif !defined(USE_ESP8266)
+#include <pthread.h>
+#endif
+
+namespace esphome
+{
+    namespace samsung_ac
+    {
+        // frames between the task and the main loop, a full ring drops frames (and counts them)
+        const size_t rxRingSize = 4096;
+
+        // an incomplete frame is discarded once the bus was silent for this long
+        const uint16_t rxFrameTimeout = 100;
+
+        // above the main loop, below the WiFi and lwIP tasks
+        const uint8_t rxTaskPriority = 5;
+
+        // Drains the UART on its own task, so a slow main loop can not overflow the receive buffer.
+        //
+        // The task only frames the bytes (see frame.h), decoding stays in the main loop because it shares the
+        // protocol state with the send path. Frames are handed over in the capture record format
+        // (see capture.h) through a lock-free ring. The UART drivers of ESPHome lock internally,
+        // so the main loop keeps writing to the UART while the task reads from it.
+        class RxTask
+        {
+        public:
+            ~RxTask() { stop(); }
+
+            // returns false if the platform has no tasks, the main loop reads the UART then
+            bool start(uart::UARTDevice *uart);
+            void stop();
+
+            bool is_running() const
+            {
+                return running_.load(std::memory_order_relaxed);
+            }
+
+            // main loop: takes the next frame, data is replaced with its bytes
+            bool pop(uint32_t &time, CaptureDirection &direction, std::vector<uint8_t> &data);
+
+            // main loop: time of the last received byte, also of incomplete frames
+            uint32_t last_activity() const
+            {
+                return last_activity_.load(std::memory_order_relaxed);
+            }
+
+            // main loop: a frame is being received, nothing should be sent now
+            bool receiving() const
+            {
+                return receiving_.load(std::memory_order_relaxed);
+            }
+
+            uint32_t dropped() const
+            {
+                return dropped_.load(std::memory_order_relaxed);
+            }
+
+            // one pass of the task, can be called without a task in tests
+            void poll(uart::UARTDevice *uart, uint32_t now);
+
+        protected:
+            void run();
+            void push(uint32_t time, CaptureDirection direction, size_t length);
+
+            uart::UARTDevice *uart_{nullptr};
+            std::vector<uint8_t> data_;
+            uint32_t last_byte_ = 0;
+            SpscRing<rxRingSize> ring_;
+            std::atomic<bool> running_{false};
+            std::atomic<bool> receiving_{false};
+            std::atomic<uint32_t> last_activity_{0};
+            std::atomic<uint32_t> dropped_{0};
+
+#if defined(USE_ESP32)
+            std::atomic<bool> finished_{false};
+#elif !defined(USE_ESP8266)
+            pthread_t thread_;
+#endif
+        };
+    } // namespace samsung_ac
+} // namespace esphome
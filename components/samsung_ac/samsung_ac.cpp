@@ -2,7 +2,9 @@
 #include "debug_mqtt.h"
 #include "util.h"
 #include "samsung_ac_log.h"
+#include "protocol_non_nasa.h"
 #include <vector>
+#include <cstring>
 
 namespace esphome
 {
@@ -18,6 +20,42 @@ namespace esphome
       {
         this->flow_control_pin_->setup();
       }
+
+      addresses_.add_on_change_callback([this](const DiscoveredAddress &entry, DiscoveryEvent event)
+                                        { on_discovery_event(entry, event); });
+      this->set_interval("availability", availabilityCheckInterval, [this]()
+                         { addresses_.expire(millis(), device_timeout_); });
+      for (Samsung_AC_Device *device : devices_)
+      {
+        device->update_availability(false);
+      }
+
+      if (restore_state_)
+      {
+        restore_topology();
+        for (Samsung_AC_Device *device : devices_)
+        {
+          device->restore_state();
+        }
+      }
+
+      // a passive bus monitor can't ask for missing values
+      if (!passive_mode)
+      {
+        sync_started_ = millis();
+        for (Samsung_AC_Device *device : devices_)
+        {
+          device->start_sync();
+        }
+      }
+
+      if (raw_stream_port_ != 0)
+        raw_stream_.setup(raw_stream_port_);
+
+      if (rx_task_enabled_ && !rx_task_.start(this))
+        LOGW("Could not start the RX task, reading the UART in the main loop");
+
+      LOGC("Data Processing starting%s", passive_mode ? " (passive)" : "");
     }
 
     void Samsung_AC::update()
@@ -27,43 +65,75 @@ namespace esphome
         LOGW("update");
       }
 
-      for (const auto &pair : devices_)
+      if (restore_state_)
       {
-        optional<Mode> current_value = pair.second->_cur_mode;
-        std::string address = pair.second->address;
-
-        if (current_value.has_value())
+        save_topology();
+        for (Samsung_AC_Device *device : devices_)
         {
-          state_tracker_.update(address, current_value.value());
+          device->save_state();
         }
       }
 
       debug_mqtt_connect(debug_mqtt_host, debug_mqtt_port, debug_mqtt_username, debug_mqtt_password);
 
-      // Waiting for first update before beginning processing data
-      if (data_processing_init)
+      // building these strings is expensive with many units, so only log them when they change
+      if (topology_changed_)
       {
-        LOGC("Data Processing starting");
-        data_processing_init = false;
+        topology_changed_ = false;
+        log_topology();
       }
+    }
+
+    void Samsung_AC::on_discovery_event(const DiscoveredAddress &entry, DiscoveryEvent event)
+    {
+      const bool online = event == DiscoveryEvent::Added;
+      LOGC("Address %s is %s", unpack_address(entry.address).c_str(), online ? "online" : "offline");
+      topology_changed_ = true;
+
+      Samsung_AC_Device *device = devices_.find(entry.address);
+      if (device == nullptr)
+        return;
+
+      device->update_availability(online);
+      if (!online)
+      {
+        device->mark_unavailable();
+      }
+      else if (device->is_unavailable())
+      {
+        // the unit was switched off or disconnected, it might have been changed in the meantime
+        device->mark_available();
+        if (!passive_mode)
+        {
+          // sync_update requests the values again, with the same retries and timeout as after boot
+          device->start_sync();
+          sync_started_ = millis();
+          sync_requested_ = false;
+          sync_done_ = false;
+        }
+      }
+    }
 
+    void Samsung_AC::log_topology()
+    {
       std::string devices;
-      for (const auto &pair : devices_)
+      for (Samsung_AC_Device *device : devices_)
       {
         if (!devices.empty())
           devices += ", ";
-        devices += pair.second->address;
+        devices += device->address;
       }
       LOGC("Configured devices: %s", devices.c_str());
 
-      std::string knownIndoor, knownOutdoor, knownOther;
-      for (const auto &address : addresses_)
+      std::string knownIndoor, knownOutdoor, knownOther, offline;
+      for (const auto &entry : addresses_)
       {
-        auto &target = (get_address_type(address) == AddressType::Outdoor) ? knownOutdoor : (get_address_type(address) == AddressType::Indoor) ? knownIndoor
-                                                                                                                                               : knownOther;
+        auto &target = !entry.online ? offline : (entry.type == AddressType::Outdoor) ? knownOutdoor
+                                             : (entry.type == AddressType::Indoor)    ? knownIndoor
+                                                                                      : knownOther;
         if (!target.empty())
           target += ", ";
-        target += address;
+        target += unpack_address(entry.address);
       }
 
       LOGC("Discovered devices:");
@@ -73,6 +143,73 @@ namespace esphome
       {
         LOGC("  Other:   %s", knownOther.c_str());
       }
+      if (offline.length() > 0)
+      {
+        LOGC("  Offline: %s", offline.c_str());
+      }
+    }
+
+    void Samsung_AC::restore_topology()
+    {
+      topology_pref_ = global_preferences->make_preference<TopologyPreference>(fnv1_hash("samsung_ac_topology"), true);
+
+      TopologyPreference topology;
+      if (!topology_pref_.load(&topology))
+        return;
+      saved_topology_ = topology;
+
+      protocol_processing = (ProtocolProcessing)topology.protocol;
+      protocol_restored_ = protocol_processing != ProtocolProcessing::Auto;
+      if (protocol_processing == ProtocolProcessing::NonNASA)
+        controller_registered = topology.controller_registered != 0;
+
+      for (uint8_t i = 0; i < topology.address_count && i < maxStoredAddresses; i++)
+      {
+        const uint8_t *stored = topology.addresses[i];
+        PackedAddress address;
+        if (protocol_processing == ProtocolProcessing::NonNASA)
+          address = nonNasaAddressFlag | stored[0];
+        else
+          address = stored[0] << 16 | stored[1] << 8 | stored[2];
+        addresses_.restore(address, get_address_type(unpack_address(address)));
+      }
+
+      LOGC("Restored protocol %d and %d discovered addresses", (int)protocol_processing, topology.address_count);
+    }
+
+    void Samsung_AC::save_topology()
+    {
+      TopologyPreference topology;
+      memset(&topology, 0, sizeof(topology));
+      topology.protocol = (uint8_t)protocol_processing;
+      topology.controller_registered = controller_registered ? 1 : 0;
+
+      for (const auto &entry : addresses_)
+      {
+        const PackedAddress address = entry.address;
+        if (topology.address_count >= maxStoredAddresses)
+          break;
+        if (address == invalidPackedAddress)
+          continue;
+
+        uint8_t *stored = topology.addresses[topology.address_count++];
+        if (address & nonNasaAddressFlag)
+        {
+          stored[0] = address & 0xFF;
+        }
+        else
+        {
+          stored[0] = (address >> 16) & 0xFF;
+          stored[1] = (address >> 8) & 0xFF;
+          stored[2] = address & 0xFF;
+        }
+      }
+
+      if (memcmp(&topology, &saved_topology_, sizeof(topology)) == 0)
+        return;
+
+      if (topology_pref_.save(&topology))
+        saved_topology_ = topology;
     }
 
     void Samsung_AC::register_device(Samsung_AC_Device *device)
@@ -83,21 +220,75 @@ namespace esphome
         return;
       }
 
-      devices_.insert({device->address, device});
+      device->handle = devices_.add(device->packed_address, device);
+      if (device->handle == DeviceRegistry<Samsung_AC_Device *>::invalidHandle)
+        LOGW("Could not register device %s, invalid address or too many devices", device->address.c_str());
+    }
+
+    void Samsung_AC::publish_group_request(const std::vector<std::string> &addresses, ProtocolRequest &request, bool broadcast)
+    {
+      if (passive_mode)
+      {
+        LOGW("Passive mode, ignoring group control");
+        return;
+      }
+
+      if (broadcast)
+      {
+        // the frame reaches every NASA indoor unit, also the ones which are not configured here
+        for (Samsung_AC_Device *device : devices_)
+        {
+          if (is_nasa_address(device->address) && get_address_type(device->address) == AddressType::Indoor)
+            device->publish_optimistic(request);
+        }
+        ProtocolRequest group_request = request;
+        nasaProtocol->publish_group_request(this, {}, group_request, true);
+        return;
+      }
+
+      std::map<Protocol *, std::vector<std::string>> groups;
+      for (const auto &address : addresses)
+      {
+        groups[get_protocol(address)].push_back(address);
+        Samsung_AC_Device *device = find_device(address);
+        if (device != nullptr)
+          device->publish_optimistic(request);
+      }
+
+      for (auto &group : groups)
+      {
+        ProtocolRequest group_request = request;
+        group.first->publish_group_request(this, group.second, group_request, false);
+      }
     }
 
     void Samsung_AC::dump_config()
     {
       LOGC("Samsung_AC:");
       LOG_PIN("  Flow Control Pin: ", this->flow_control_pin_);
+      LOGC("  RX task: %s", rx_task_.is_running() ? "running" : "off");
+
+      size_t total = devices_.memory_usage() + addresses_.memory_usage();
+      for (Samsung_AC_Device *device : devices_)
+      {
+        size_t usage = device->memory_usage();
+        LOGC("  Device %s: handle %u, %u bytes", device->address.c_str(), (unsigned)device->handle, (unsigned)usage);
+        total += usage;
+      }
+      LOGC("  Devices: %u configured, %u discovered, %u bytes", (unsigned)devices_.size(), (unsigned)addresses_.size(), (unsigned)total);
     }
     void Samsung_AC::publish_data(uint8_t id, std::vector<uint8_t> &&data)
     {
+      // last line of defence, every transmit path ends here
+      if (passive_mode)
+        return;
+
       const uint32_t now = millis();
 
       if (id == 0)
       {
         LOG_RAW_SEND(now-last_transmission_, data);
+        raw_stream_.add(now, CaptureDirection::Sent, data.data(), data.size());
         last_transmission_ = now;
         this->before_write();
         this->write_array(data);
@@ -128,14 +319,17 @@ namespace esphome
 
     void Samsung_AC::loop()
     {
-      if (data_processing_init)
-        return;
-
       const uint32_t now = millis();
+      debug_mqtt_flush();
+      raw_stream_.loop(now);
       // if more data is expected, do not allow anything to be written
       if (!read_data())
         return;
 
+      // nothing is sent and no protocol keeps any requests in passive mode
+      if (passive_mode)
+        return;
+
       // If there is no data we use the time to send
       // And if written, break the loop
       if (write_data())
@@ -145,16 +339,62 @@ namespace esphome
       if (now - last_protocol_update_ >= 200)
       {
         last_protocol_update_ = now;
-        for (const auto &pair : devices_)
+        sync_update(now);
+        for (Samsung_AC_Device *device : devices_)
         {
-          Samsung_AC_Device *device = pair.second;
+          device->flush_debounced(now);
           device->protocol_update(this);
         }
       }
     }
 
+    void Samsung_AC::sync_update(uint32_t now)
+    {
+      if (sync_done_)
+        return;
+
+      const bool request = !sync_requested_ || now - last_sync_request_ >= syncRetryInterval;
+      if (request)
+      {
+        sync_requested_ = true;
+        last_sync_request_ = now;
+      }
+
+      bool synced = true;
+      for (Samsung_AC_Device *device : devices_)
+      {
+        if (device->is_synced())
+          continue;
+
+        synced = false;
+        if (request)
+          device->request_sync();
+      }
+
+      const uint32_t elapsed = now - sync_started_;
+      if (synced)
+      {
+        LOGC("State of all devices synced after %u ms", elapsed);
+        if (sync_time_sensor_ != nullptr)
+          sync_time_sensor_->publish_state(elapsed);
+        sync_done_ = true;
+      }
+      else if (elapsed > syncTimeout)
+      {
+        for (Samsung_AC_Device *device : devices_)
+        {
+          if (!device->is_synced())
+            LOGW("Device %s did not report all configured values after %u ms", device->address.c_str(), elapsed);
+        }
+        sync_done_ = true;
+      }
+    }
+
     bool Samsung_AC::read_data()
     {
+      if (rx_task_.is_running())
+        return read_frames();
+
       // read as long as there is anything to read
       while (available())
       {
@@ -179,11 +419,76 @@ namespace esphome
         // collect more so that we can log all discarded bytes at once, but don't wait for too long
         if (result.bytes == data_.size() && now-last_transmission_ < 1000)
           return false;
+      }
+
+      consume_data(now, result);
+      last_transmission_ = now;
+      return false;
+    }
+
+    bool Samsung_AC::read_frames()
+    {
+      uint32_t time;
+      CaptureDirection direction;
+      bool received = false;
+      while (rx_task_.pop(time, direction, data_))
+      {
+        received = true;
+        if (direction == CaptureDirection::Discarded)
+        {
+          consume_data(time, {DecodeResultType::Discard, (uint16_t)data_.size()});
+          continue;
+        }
+
+        // the task already framed the bytes, so they never need more data
+        while (!data_.empty())
+        {
+          auto result = process_data(data_, this);
+          if (result.type == DecodeResultType::Fill)
+            result = {DecodeResultType::Discard, (uint16_t)data_.size()};
+          consume_data(time, result);
+        }
+      }
+
+      const uint32_t dropped = rx_task_.dropped();
+      if (dropped != reported_rx_dropped_)
+      {
+        LOGW("RX task dropped %u frames, the main loop did not keep up", dropped - reported_rx_dropped_);
+        reported_rx_dropped_ = dropped;
+      }
+
+      // also counts bytes of frames which are still being received
+      const uint32_t activity = rx_task_.last_activity();
+      if ((int32_t)(activity - last_transmission_) > 0)
+        last_transmission_ = activity;
+
+      return !received && !rx_task_.receiving();
+    }
+
+    void Samsung_AC::consume_data(uint32_t now, DecodeResult result)
+    {
+      if (result.type == DecodeResultType::Discard)
+      {
         LOG_RAW_DISCARDED(now-last_transmission_, data_, 0, result.bytes);
+        raw_stream_.add(now, CaptureDirection::Discarded, data_.data(), result.bytes);
+
+        // the restored protocol might not match the bus anymore (e.g. device moved to another unit)
+        if (protocol_restored_)
+        {
+          restored_discarded_bytes_ += result.bytes;
+          if (restored_discarded_bytes_ > 512)
+          {
+            LOGW("Restored protocol does not match the bus, detecting it again");
+            protocol_processing = ProtocolProcessing::Auto;
+            protocol_restored_ = false;
+          }
+        }
       }
       else
       {
         LOG_RAW(now-last_transmission_, data_, 0, result.bytes);
+        raw_stream_.add(now, CaptureDirection::Received, data_.data(), result.bytes);
+        protocol_restored_ = false;
       }
 
       if (result.bytes == data_.size())
@@ -193,9 +498,6 @@ namespace esphome
         std::move(data_.begin() + result.bytes, data_.end(), data_.begin());
         data_.resize(data_.size() - result.bytes);
       }
-
-      last_transmission_ = now;
-      return false;
     }
 
     bool Samsung_AC::write_data()
@@ -220,6 +522,7 @@ namespace esphome
         }
 
         LOG_RAW_SEND(now-last_transmission_, senddata->data);
+        raw_stream_.add(now, CaptureDirection::Sent, senddata->data.data(), senddata->data.size());
 
         last_transmission_ = now;
         senddata->nextRetry = now + retryInterval;
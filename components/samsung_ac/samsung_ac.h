@@ -1,15 +1,17 @@
 #pragma once
 
-#include <set>
 #include <map>
 #include <optional>
 #include <queue>
 #include "esphome/core/component.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/uart/uart.h"
 #include "samsung_ac_device.h"
 #include "protocol.h"
 #include "samsung_ac_log.h"
-#include "device_state_tracker.h"
+#include "device_registry.h"
+#include "raw_stream.h"
+#include "rx_task.h"
 
 namespace esphome
 {
@@ -30,6 +32,27 @@ namespace esphome
     // maximum time to wait before discarding command
     const uint16_t sendTimeout = 4000;
 
+    // time between read requests for fields still missing after boot
+    const uint16_t syncRetryInterval = 5000;
+
+    // stop waiting for missing fields after boot
+    const uint32_t syncTimeout = 120000;
+
+    // interval of the scan for addresses which went quiet
+    const uint16_t availabilityCheckInterval = 5000;
+
+    // number of discovered addresses which are kept across reboots
+    const uint8_t maxStoredAddresses = 64;
+
+    // discovered bus topology, restored at boot so detection does not start from scratch
+    struct TopologyPreference
+    {
+      uint8_t protocol; // ProtocolProcessing
+      uint8_t controller_registered;
+      uint8_t address_count;
+      uint8_t addresses[maxStoredAddresses][3]; // cc.hh.aa, NonNASA only uses the first byte
+    };
+
     struct OutgoingData
     {
       uint8_t id;
@@ -52,18 +75,18 @@ namespace esphome
       void loop() override;
       void dump_config() override;
 
-      template <typename SensorType, typename ValueType>
-      void update_device_sensor(const std::string &address, SensorType Samsung_AC_Device::*sensor_ptr, ValueType value)
+      template <typename ValueType>
+      void update_device_sensor(PackedAddress address, SensorSlot slot, ValueType value)
       {
         Samsung_AC_Device *dev = find_device(address);
-        if (dev != nullptr && dev->*sensor_ptr != nullptr)
+        if (dev != nullptr)
         {
-          dev->update_sensor_state(dev->*sensor_ptr, value);
+          dev->update_sensor_state(slot, value);
         }
       }
 
       template <typename Func>
-      void execute_if_device_exists(const std::string &address, Func func)
+      void execute_if_device_exists(PackedAddress address, Func func)
       {
         Samsung_AC_Device *dev = find_device(address);
         if (dev != nullptr)
@@ -85,6 +108,16 @@ namespace esphome
         debug_mqtt_password = password;
       }
 
+      void set_sync_time_sensor(sensor::Sensor *sensor)
+      {
+        sync_time_sensor_ = sensor;
+      }
+
+      void set_restore_state(bool value)
+      {
+        restore_state_ = value;
+      }
+
       void set_debug_log_messages(bool value)
       {
         debug_log_messages = value;
@@ -99,6 +132,31 @@ namespace esphome
       {
         non_nasa_keepalive = value;
       }
+
+      void set_passive(bool value)
+      {
+        passive_mode = value;
+      }
+
+      void set_device_timeout(uint32_t value)
+      {
+        device_timeout_ = value;
+      }
+
+      void set_raw_stream_port(uint16_t value)
+      {
+        raw_stream_port_ = value;
+      }
+
+      void set_rx_task(bool value)
+      {
+        rx_task_enabled_ = value;
+      }
+
+      void set_nasa_poll_bus_utilisation(float value)
+      {
+        nasa_poll_bus_utilisation = value;
+      }
       void set_debug_log_undefined_messages(bool value)
       {
         debug_log_undefined_messages = value;
@@ -106,9 +164,16 @@ namespace esphome
 
       void register_device(Samsung_AC_Device *device);
 
-      void register_address(const std::string address) override
+      // sends one request to a group of units, grouped by the protocol they use.
+      // a broadcast goes to every NASA indoor unit, addresses are not used then
+      void publish_group_request(const std::vector<std::string> &addresses, ProtocolRequest &request, bool broadcast);
+
+      void register_address(PackedAddress address) override
       {
-        addresses_.insert(address);
+        // called for every frame, only unknown addresses are classified
+        const uint32_t now = millis();
+        if (!addresses_.seen(address, now))
+          addresses_.add(address, get_address_type(unpack_address(address)), now);
       }
 
       uint32_t get_miliseconds()
@@ -120,161 +185,183 @@ namespace esphome
 
       void ack_data(uint8_t id);
 
-      void set_room_temperature(const std::string address, float value) override
+      void set_room_temperature(PackedAddress address, Temperature value) override
       {
         execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
                                  { dev->update_room_temperature(value); });
       }
 
-      void set_outdoor_temperature(const std::string address, float value) override
+      void set_outdoor_temperature(PackedAddress address, Temperature value) override
       {
-        execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
-                                 { dev->update_sensor_state(dev->outdoor_temperature, value); });
+        update_device_sensor(address, SensorSlot::OutdoorTemperature, value);
       }
 
-      void set_indoor_eva_in_temperature(const std::string address, float value) override
+      void set_indoor_eva_in_temperature(PackedAddress address, Temperature value) override
       {
-        execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
-                                 { dev->update_sensor_state(dev->indoor_eva_in_temperature, value); });
+        update_device_sensor(address, SensorSlot::IndoorEvaInTemperature, value);
       }
 
-      void set_indoor_eva_out_temperature(const std::string address, float value) override
+      void set_indoor_eva_out_temperature(PackedAddress address, Temperature value) override
       {
-        execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
-                                 { dev->update_sensor_state(dev->indoor_eva_out_temperature, value); });
+        update_device_sensor(address, SensorSlot::IndoorEvaOutTemperature, value);
       }
 
-      void set_target_temperature(const std::string address, float value) override
+      void set_target_temperature(PackedAddress address, Temperature value) override
       {
         execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
                                  { dev->update_target_temperature(value); });
       }
 
-      void set_water_outlet_target(const std::string address, float value) override
+      void set_water_outlet_target(PackedAddress address, Temperature value) override
       {
         execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
                                  { dev->update_water_outlet_target(value); });
       }
 
-      void set_target_water_temperature(const std::string address, float value) override
+      void set_target_water_temperature(PackedAddress address, Temperature value) override
       {
         execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
                                  { dev->update_target_water_temperature(value); });
       }
 
-      void set_power(const std::string address, bool value) override
+      void set_power(PackedAddress address, bool value) override
       {
         execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
                                  { dev->update_power(value); });
       }
-      void set_automatic_cleaning(const std::string address, bool value) override
+      void set_automatic_cleaning(PackedAddress address, bool value) override
       {
         execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
                                  { dev->update_automatic_cleaning(value); });
       }
 
-      void set_water_heater_power(const std::string address, bool value) override
+      void set_water_heater_power(PackedAddress address, bool value) override
       {
         execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
                                  { dev->update_water_heater_power(value); });
       }
 
-      void set_mode(const std::string address, Mode mode) override
+      void set_mode(PackedAddress address, Mode mode) override
       {
         execute_if_device_exists(address, [mode](Samsung_AC_Device *dev)
                                  { dev->update_mode(mode); });
       }
 
-      void set_water_heater_mode(const std::string address, WaterHeaterMode waterheatermode) override
+      void set_water_heater_mode(PackedAddress address, WaterHeaterMode waterheatermode) override
       {
         execute_if_device_exists(address, [waterheatermode](Samsung_AC_Device *dev)
                                  { dev->update_water_heater_mode(waterheatermode); });
       }
 
-      void set_fanmode(const std::string address, FanMode fanmode) override
+      void set_fanmode(PackedAddress address, FanMode fanmode) override
       {
         execute_if_device_exists(address, [fanmode](Samsung_AC_Device *dev)
                                  { dev->update_fanmode(fanmode); });
       }
 
-      void set_altmode(const std::string address, AltMode altmode) override
+      void set_altmode(PackedAddress address, AltMode altmode) override
       {
         execute_if_device_exists(address, [altmode](Samsung_AC_Device *dev)
                                  { dev->update_altmode(altmode); });
       }
 
-      void set_swing_vertical(const std::string address, bool vertical) override
+      void set_swing_vertical(PackedAddress address, bool vertical) override
       {
         execute_if_device_exists(address, [vertical](Samsung_AC_Device *dev)
                                  { dev->update_swing_vertical(vertical); });
       }
 
-      void set_swing_horizontal(const std::string address, bool horizontal) override
+      void set_swing_horizontal(PackedAddress address, bool horizontal) override
       {
         execute_if_device_exists(address, [horizontal](Samsung_AC_Device *dev)
                                  { dev->update_swing_horizontal(horizontal); });
       }
 
-      void set_custom_sensor(const std::string address, uint16_t message_number, float value) override
+      void set_custom_sensor(PackedAddress address, uint16_t message_number, long value) override
       {
         execute_if_device_exists(address, [message_number, value](Samsung_AC_Device *dev)
                                  { dev->update_custom_sensor(message_number, value); });
       }
 
-      void set_error_code(const std::string address, int value) override
+      void set_error_code(PackedAddress address, int value) override
       {
         execute_if_device_exists(address, [value](Samsung_AC_Device *dev)
                                  { dev->update_error_code(value); });
       }
 
-      void set_outdoor_instantaneous_power(const std::string &address, float value)
+      void set_outdoor_instantaneous_power(PackedAddress address, float value)
       {
-        update_device_sensor(address, &Samsung_AC_Device::outdoor_instantaneous_power, value);
+        update_device_sensor(address, SensorSlot::OutdoorInstantaneousPower, value);
       }
 
-      void set_outdoor_cumulative_energy(const std::string &address, float value)
+      void set_outdoor_cumulative_energy(PackedAddress address, float value)
       {
-        update_device_sensor(address, &Samsung_AC_Device::outdoor_cumulative_energy, value);
+        update_device_sensor(address, SensorSlot::OutdoorCumulativeEnergy, value);
       }
 
-      void set_outdoor_current(const std::string &address, float value)
+      void set_outdoor_current(PackedAddress address, float value)
       {
-        update_device_sensor(address, &Samsung_AC_Device::outdoor_current, value);
+        update_device_sensor(address, SensorSlot::OutdoorCurrent, value);
       }
 
-      void set_outdoor_voltage(const std::string &address, float value)
+      void set_outdoor_voltage(PackedAddress address, float value)
       {
-        update_device_sensor(address, &Samsung_AC_Device::outdoor_voltage, value);
+        update_device_sensor(address, SensorSlot::OutdoorVoltage, value);
       }
 
     protected:
       Samsung_AC_Device *find_device(const std::string &address)
       {
-        auto it = devices_.find(address);
-        if (it != devices_.end())
-        {
-          return it->second;
-        }
-        return nullptr;
+        return devices_.find(pack_address(address));
+      }
+
+      Samsung_AC_Device *find_device(PackedAddress address)
+      {
+        return devices_.find(address);
       }
 
-      std::map<std::string, Samsung_AC_Device *> devices_;
-      DeviceStateTracker<Mode> state_tracker_{1000};
-      std::set<std::string> addresses_;
+      DeviceRegistry<Samsung_AC_Device *> devices_;
+      DiscoveryRegistry addresses_;
+      void on_discovery_event(const DiscoveredAddress &entry, DiscoveryEvent event);
+      void log_topology();
+      bool topology_changed_ = true;
+      uint32_t device_timeout_ = 120000;
+
+      RawStream raw_stream_;
+      uint16_t raw_stream_port_ = 0;
+
+      RxTask rx_task_;
+      bool rx_task_enabled_ = false;
+      uint32_t reported_rx_dropped_ = 0;
 
       std::deque<OutgoingData> send_queue_;
       std::vector<uint8_t> data_;
       bool read_data();
+      bool read_frames();
+      void consume_data(uint32_t now, DecodeResult result);
       void before_write();
       bool write_data();
       void after_write();
       uint32_t last_transmission_ = 0;
       uint32_t last_protocol_update_ = 0;
 
-      bool data_processing_init = true;
+      void sync_update(uint32_t now);
+      uint32_t sync_started_ = 0;
+      uint32_t last_sync_request_ = 0;
+      bool sync_requested_ = false;
+      bool sync_done_ = false;
+      sensor::Sensor *sync_time_sensor_{nullptr};
+
+      void restore_topology();
+      void save_topology();
+      ESPPreferenceObject topology_pref_;
+      TopologyPreference saved_topology_{};
+      bool protocol_restored_ = false;
+      uint16_t restored_discarded_bytes_ = 0;
 
       // settings from yaml
       GPIOPin *flow_control_pin_{nullptr};
+      bool restore_state_ = true;
       std::string debug_mqtt_host = "";
       uint16_t debug_mqtt_port = 1883;
       std::string debug_mqtt_username = "";
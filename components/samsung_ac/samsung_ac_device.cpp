@@ -2,15 +2,363 @@
 #include "samsung_ac.h"
 #include "util.h"
 #include "conversions.h"
+#include "protocol_nasa.h"
 #include <vector>
 #include <set>
 #include <algorithm>
+#include <cstring>
 
 namespace esphome
 {
   namespace samsung_ac
   {
-    climate::ClimateTraits Samsung_AC_Climate::traits()
+    void Samsung_AC_Device::restore_state()
+    {
+      state_pref_ = global_preferences->make_preference<DeviceStatePreference>(fnv1_hash("samsung_ac_state_" + address), true);
+      saved_state_ = current_state();
+
+      DeviceStatePreference state;
+      if (!state_pref_.load(&state))
+        return;
+      saved_state_ = state;
+
+      if (state.target_temperature != INT16_MIN)
+        update_target_temperature(Temperature::from_tenths(state.target_temperature));
+      if (state.water_outlet_target != INT16_MIN)
+        update_water_outlet_target(Temperature::from_tenths(state.water_outlet_target));
+      if (state.target_water_temperature != INT16_MIN)
+        update_target_water_temperature(Temperature::from_tenths(state.target_water_temperature));
+      if (state.power >= 0)
+        update_power(state.power != 0);
+      if (state.automatic_cleaning >= 0)
+        update_automatic_cleaning(state.automatic_cleaning != 0);
+      if (state.mode >= 0)
+        update_mode((Mode)state.mode);
+      if (state.fanmode >= 0)
+        update_fanmode((FanMode)state.fanmode);
+      if (state.water_heater_power >= 0)
+        update_water_heater_power(state.water_heater_power != 0);
+      if (state.water_heater_mode >= 0)
+        update_water_heater_mode((WaterHeaterMode)state.water_heater_mode);
+    }
+
+    DeviceStatePreference Samsung_AC_Device::current_state()
+    {
+      // measurements like the room temperature are not stored, they change too often
+      DeviceStatePreference state;
+      memset(&state, 0, sizeof(state));
+      state.target_temperature = _cur_target_temperature.has_value() ? _cur_target_temperature.value().tenths : INT16_MIN;
+      state.water_outlet_target = _cur_water_outlet_target.has_value() ? _cur_water_outlet_target.value().tenths : INT16_MIN;
+      state.target_water_temperature = _cur_target_water_temperature.has_value() ? _cur_target_water_temperature.value().tenths : INT16_MIN;
+      state.power = _cur_power.has_value() ? _cur_power.value() : -1;
+      state.automatic_cleaning = _cur_automatic_cleaning.has_value() ? _cur_automatic_cleaning.value() : -1;
+      state.mode = (int8_t)(_cur_mode.has_value() ? _cur_mode.value() : Mode::Unknown);
+      state.fanmode = (int8_t)(_cur_fanmode.has_value() ? _cur_fanmode.value() : FanMode::Unknown);
+      state.water_heater_power = _cur_water_heater_power.has_value() ? _cur_water_heater_power.value() : -1;
+      state.water_heater_mode = (int8_t)(_cur_water_heater_mode.has_value() ? _cur_water_heater_mode.value() : WaterHeaterMode::Unknown);
+      return state;
+    }
+
+    void Samsung_AC_Device::save_state()
+    {
+      DeviceStatePreference state = current_state();
+      if (memcmp(&state, &saved_state_, sizeof(state)) == 0)
+        return;
+
+      if (state_pref_.save(&state))
+        saved_state_ = state;
+    }
+
+    void Samsung_AC_Device::start_sync()
+    {
+      // NonNASA devices send their complete state with every status message
+      if (!is_nasa_address(address))
+        return;
+
+      // also restarted when the unit comes back online
+      sync_started_ = millis();
+
+      auto add = [this](MessageNumber message_number)
+      { sync_pending_.push_back((uint16_t)message_number); };
+
+      if (get_sensor(SensorSlot::RoomTemperature) != nullptr || climate != nullptr)
+        add(MessageNumber::VAR_in_temp_room_f);
+      if (target_temperature != nullptr || climate != nullptr)
+        add(MessageNumber::VAR_in_temp_target_f);
+      if (power != nullptr || climate != nullptr)
+        add(MessageNumber::ENUM_in_operation_power);
+      if (mode != nullptr || climate != nullptr)
+        add(MessageNumber::ENUM_in_operation_mode);
+      if (climate != nullptr)
+      {
+        add(MessageNumber::ENUM_in_fan_mode);
+        if (!alt_modes.empty())
+          add(MessageNumber::ENUM_in_alt_mode);
+        if (supports_vertical_swing_)
+          add(MessageNumber::ENUM_in_louver_hl_swing);
+        if (supports_horizontal_swing_)
+          add(MessageNumber::ENUM_in_louver_lr_swing);
+      }
+      if (automatic_cleaning != nullptr)
+        add(MessageNumber::ENUM_in_operation_automatic_cleaning);
+      if (water_heater_power != nullptr)
+        add(MessageNumber::ENUM_in_water_heater_power);
+      if (waterheatermode != nullptr)
+        add(MessageNumber::ENUM_in_water_heater_mode);
+      if (water_outlet_target != nullptr)
+        add(MessageNumber::VAR_in_temp_water_outlet_target_f);
+      if (target_water_temperature != nullptr)
+        add(MessageNumber::VAR_in_temp_water_heater_target_f);
+      if (get_sensor(SensorSlot::OutdoorTemperature) != nullptr)
+        add(MessageNumber::VAR_out_sensor_airout);
+      if (get_sensor(SensorSlot::IndoorEvaInTemperature) != nullptr)
+        add(MessageNumber::VAR_in_temp_eva_in_f);
+      if (get_sensor(SensorSlot::IndoorEvaOutTemperature) != nullptr)
+        add(MessageNumber::VAR_in_temp_eva_out_f);
+      if (get_sensor(SensorSlot::ErrorCode) != nullptr)
+        add(MessageNumber::VAR_out_error_code);
+      if (get_sensor(SensorSlot::OutdoorInstantaneousPower) != nullptr)
+        add(MessageNumber::LVAR_OUT_CONTROL_WATTMETER_1W_1MIN_SUM);
+      if (get_sensor(SensorSlot::OutdoorCumulativeEnergy) != nullptr)
+        add(MessageNumber::LVAR_OUT_CONTROL_WATTMETER_ALL_UNIT_ACCUM);
+      if (get_sensor(SensorSlot::OutdoorCurrent) != nullptr)
+        add(MessageNumber::VAR_OUT_SENSOR_CT1);
+      if (get_sensor(SensorSlot::OutdoorVoltage) != nullptr)
+        add(MessageNumber::LVAR_NM_OUT_SENSOR_VOLTAGE);
+
+      for (const auto &entry : custom_sensors)
+      {
+        sync_pending_.push_back(entry.message_number);
+      }
+
+      std::sort(sync_pending_.begin(), sync_pending_.end());
+      sync_pending_.erase(std::unique(sync_pending_.begin(), sync_pending_.end()), sync_pending_.end());
+      sync_pending_.shrink_to_fit();
+    }
+
+    void Samsung_AC_Device::mark_unavailable()
+    {
+      unavailable_ = true;
+
+      // switches and selects have no unknown state, they keep their last value
+      for (const auto &entry : sensors_)
+        entry.sensor->publish_state(NAN);
+      for (const auto &entry : custom_sensors)
+        entry.sensor->publish_state(NAN);
+      for (Samsung_AC_Number *number : {target_temperature, water_outlet_target, target_water_temperature})
+      {
+        if (number != nullptr)
+          number->publish_state(NAN);
+      }
+
+      _cur_room_temperature.reset();
+      if (climate != nullptr)
+      {
+        climate->current_temperature = NAN;
+        climate->target_temperature = NAN;
+        climate->publish_state();
+      }
+    }
+
+    // the fields of ProtocolRequest which can be debounced, in the order of Samsung_AC_Device::debounced_
+    static optional<float> ProtocolRequest::*const debounced_fields[] = {
+        &ProtocolRequest::target_temp,
+        &ProtocolRequest::water_outlet_target,
+        &ProtocolRequest::target_water_temp,
+    };
+
+    void Samsung_AC_Device::publish_request(ProtocolRequest &request, uint32_t debounce)
+    {
+      if (debounce == 0)
+      {
+        publish_request(request);
+        return;
+      }
+      if (passive_mode)
+      {
+        ESP_LOGW(TAG, "Passive mode, ignoring control of %s", address.c_str());
+        return;
+      }
+
+      publish_optimistic(request);
+
+      const uint32_t now = millis();
+      for (size_t i = 0; i < debounced_.size(); i++)
+      {
+        optional<float> &value = request.*debounced_fields[i];
+        if (!value.has_value())
+          continue;
+        debounced_[i].value = value;
+        debounced_[i].since = now;
+        debounced_[i].window = debounce;
+        value.reset();
+      }
+      if (!request.empty())
+        protocol->publish_request(target, address, request);
+    }
+
+    void Samsung_AC_Device::flush_debounced(uint32_t now)
+    {
+      ProtocolRequest request;
+      for (size_t i = 0; i < debounced_.size(); i++)
+      {
+        DebouncedValue &debounced = debounced_[i];
+        if (!debounced.value.has_value() || now - debounced.since < debounced.window)
+          continue;
+        request.*debounced_fields[i] = debounced.value;
+        debounced.value.reset();
+      }
+      if (request.empty())
+        return;
+
+      protocol->publish_request(target, address, request);
+      restart_pending(request, now);
+    }
+
+    void Samsung_AC_Device::publish_optimistic(const ProtocolRequest &request)
+    {
+      for (size_t i = 0; i < debounced_.size(); i++)
+      {
+        if ((request.*debounced_fields[i]).has_value())
+          debounced_[i].value.reset();
+      }
+
+      // the protocols switch the unit on with every mode change
+      if (request.power.has_value() || request.mode.has_value())
+      {
+        bool value = request.power.value_or(true);
+        command_field(ControlField::Power, value, [this, value]()
+                      { update_power(value); });
+      }
+      if (request.automatic_cleaning.has_value())
+      {
+        bool value = request.automatic_cleaning.value();
+        command_field(ControlField::AutomaticCleaning, value, [this, value]()
+                      { update_automatic_cleaning(value); });
+      }
+      if (request.water_heater_power.has_value())
+      {
+        bool value = request.water_heater_power.value();
+        command_field(ControlField::WaterHeaterPower, value, [this, value]()
+                      { update_water_heater_power(value); });
+      }
+      if (request.mode.has_value())
+      {
+        Mode value = request.mode.value();
+        command_field(ControlField::Mode, (long)value, [this, value]()
+                      { update_mode(value); });
+      }
+      if (request.waterheatermode.has_value())
+      {
+        WaterHeaterMode value = request.waterheatermode.value();
+        command_field(ControlField::WaterHeaterMode, (long)value, [this, value]()
+                      { update_water_heater_mode(value); });
+      }
+      if (request.fan_mode.has_value())
+      {
+        FanMode value = request.fan_mode.value();
+        command_field(ControlField::FanMode, (long)value, [this, value]()
+                      { update_fanmode(value); });
+      }
+      if (request.alt_mode.has_value())
+      {
+        AltMode value = request.alt_mode.value();
+        command_field(ControlField::AltMode, value, [this, value]()
+                      { update_altmode(value); });
+      }
+      if (request.swing_mode.has_value())
+      {
+        const uint8_t swing = (uint8_t)request.swing_mode.value();
+        bool vertical = (swing & 1) != 0;
+        bool horizontal = (swing & 2) != 0;
+        if (supports_vertical_swing_)
+          command_field(ControlField::SwingVertical, vertical, [this, vertical]()
+                        { update_swing_vertical(vertical); });
+        if (supports_horizontal_swing_)
+          command_field(ControlField::SwingHorizontal, horizontal, [this, horizontal]()
+                        { update_swing_horizontal(horizontal); });
+      }
+      if (request.target_temp.has_value())
+      {
+        Temperature value = Temperature::from_tenths(lroundf(request.target_temp.value() * 10));
+        command_field(ControlField::TargetTemperature, value.tenths, [this, value]()
+                      { update_target_temperature(value); });
+      }
+      if (request.water_outlet_target.has_value())
+      {
+        Temperature value = Temperature::from_tenths(lroundf(request.water_outlet_target.value() * 10));
+        command_field(ControlField::WaterOutletTarget, value.tenths, [this, value]()
+                      { update_water_outlet_target(value); });
+      }
+      if (request.target_water_temp.has_value())
+      {
+        Temperature value = Temperature::from_tenths(lroundf(request.target_water_temp.value() * 10));
+        command_field(ControlField::TargetWaterTemperature, value.tenths, [this, value]()
+                      { update_target_water_temperature(value); });
+      }
+    }
+
+    void Samsung_AC_Device::restart_pending(const ProtocolRequest &request, uint32_t now)
+    {
+      if (request.power.has_value() || request.mode.has_value())
+        pending_.restart(ControlField::Power, now);
+      if (request.automatic_cleaning.has_value())
+        pending_.restart(ControlField::AutomaticCleaning, now);
+      if (request.water_heater_power.has_value())
+        pending_.restart(ControlField::WaterHeaterPower, now);
+      if (request.mode.has_value())
+        pending_.restart(ControlField::Mode, now);
+      if (request.waterheatermode.has_value())
+        pending_.restart(ControlField::WaterHeaterMode, now);
+      if (request.fan_mode.has_value())
+        pending_.restart(ControlField::FanMode, now);
+      if (request.alt_mode.has_value())
+        pending_.restart(ControlField::AltMode, now);
+      if (request.swing_mode.has_value())
+      {
+        pending_.restart(ControlField::SwingVertical, now);
+        pending_.restart(ControlField::SwingHorizontal, now);
+      }
+      if (request.target_temp.has_value())
+        pending_.restart(ControlField::TargetTemperature, now);
+      if (request.water_outlet_target.has_value())
+        pending_.restart(ControlField::WaterOutletTarget, now);
+      if (request.target_water_temp.has_value())
+        pending_.restart(ControlField::TargetWaterTemperature, now);
+    }
+
+    bool Samsung_AC_Device::accept_report(ControlField field, long value)
+    {
+      switch (pending_.report(field, value, millis()))
+      {
+      case PendingResult::Stale:
+        ESP_LOGD(TAG, "Device %s: ignoring stale %s while a command is pending", address.c_str(), control_field_to_str(field));
+        return false;
+      case PendingResult::Confirmed:
+        ESP_LOGD(TAG, "Device %s confirmed %s after %u ms", address.c_str(), control_field_to_str(field), pending_.last_latency());
+        update_sensor_state(SensorSlot::CommandLatency, (float)pending_.last_latency());
+        return true;
+      case PendingResult::Timeout:
+        ESP_LOGW(TAG, "Device %s did not apply %s within %u ms", address.c_str(), control_field_to_str(field), commandConfirmTimeout);
+        return true;
+      default:
+        return true;
+      }
+    }
+
+    size_t Samsung_AC_Device::memory_usage()
+    {
+      size_t usage = sizeof(*this) + address.capacity();
+      usage += sensors_.capacity() * sizeof(Samsung_AC_Slot_Sensor);
+      usage += custom_sensors.capacity() * sizeof(Samsung_AC_Sensor);
+      usage += sync_pending_.capacity() * sizeof(uint16_t);
+      usage += alt_modes.capacity() * sizeof(AltModeDesc);
+      for (const auto &mode : alt_modes)
+        usage += mode.name.capacity();
+      return usage;
+    }
+
+    void Samsung_AC_Climate::update_traits()
     {
       climate::ClimateTraits traits;
 
@@ -79,13 +427,11 @@ namespace esphome
         }
       }
 
-      return traits;
+      traits_ = traits;
     }
 
     void Samsung_AC_Climate::control(const climate::ClimateCall &call)
     {
-      traits();
-
       ProtocolRequest request;
 
       auto targetTempOpt = call.get_target_temperature();
@@ -126,13 +472,13 @@ namespace esphome
       auto presetOpt = call.get_preset();
       if (presetOpt.has_value())
       {
-        set_alt_mode_by_name(request, preset_to_altmodename(presetOpt.value()));
+        set_alt_mode_by_name(request, preset_to_altmodename(presetOpt.value()).c_str());
       }
 
       const char *custom_preset = call.get_custom_preset();
       if (custom_preset != nullptr && custom_preset[0] != '\0')
       {
-        set_alt_mode_by_name(request, AltModeName(custom_preset));
+        set_alt_mode_by_name(request, custom_preset);
       }
 
       auto swingModeOpt = call.get_swing_mode();
@@ -141,17 +487,18 @@ namespace esphome
         request.swing_mode = climateswingmode_to_swingmode(swingModeOpt.value());
       }
 
-      device->publish_request(request);
+      // only the target temperature is debounced (its slider), mode and fan changes are sent right away
+      device->publish_request(request, debounce);
     }
 
-    void Samsung_AC_Climate::set_alt_mode_by_name(ProtocolRequest &request, const AltModeName &name)
+    void Samsung_AC_Climate::set_alt_mode_by_name(ProtocolRequest &request, const char *name)
     {
       auto supported = device->get_supported_alt_modes();
       auto mode = std::find_if(supported->begin(), supported->end(), [&name](const AltModeDesc &x)
                                { return x.name == name; });
       if (mode == supported->end())
       {
-        ESP_LOGW(TAG, "Unsupported alt_mode %s", name.c_str());
+        ESP_LOGW(TAG, "Unsupported alt_mode %s", name);
         return;
       }
       request.alt_mode = mode->value;
@@ -1,17 +1,21 @@
 #pragma once
 
-#include <set>
 #include <optional>
 #include <algorithm>
+#include <cmath>
 #include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/sensor/sensor.h"
+#include "esphome/components/binary_sensor/binary_sensor.h"
 #include "esphome/components/select/select.h"
 #include "esphome/components/number/number.h"
 #include "esphome/components/climate/climate.h"
 #include "protocol.h"
 #include "samsung_ac.h"
 #include "conversions.h"
+#include "device_registry.h"
+#include "pending_commands.h"
 
 namespace esphome
 {
@@ -23,15 +27,30 @@ namespace esphome
     class Samsung_AC_Climate : public climate::Climate
     {
     public:
-      climate::ClimateTraits traits();
+      climate::ClimateTraits traits()
+      {
+        return traits_;
+      }
       void control(const climate::ClimateCall &call);
       void apply_fanmode_from_device(FanMode value);
       void apply_altmode_from_device(const AltModeDesc &mode);
 
+      // rebuilds the traits from the capabilities of the device, called when they change
+      void update_traits();
+
+      void set_debounce(uint32_t value)
+      {
+        debounce = value;
+      }
+
       Samsung_AC_Device *device;
+      // time the settings have to stay unchanged before they are sent
+      uint32_t debounce{0};
 
     protected:
-      void set_alt_mode_by_name(ProtocolRequest &request, const AltModeName &name);
+      void set_alt_mode_by_name(ProtocolRequest &request, const char *name);
+
+      climate::ClimateTraits traits_;
     };
 
     class Samsung_AC_Number : public number::Number
@@ -41,7 +60,13 @@ namespace esphome
       {
         write_state_(value);
       }
+      void set_debounce(uint32_t value)
+      {
+        debounce = value;
+      }
       std::function<void(float)> write_state_;
+      // time the value has to stay unchanged before it is sent
+      uint32_t debounce{0};
     };
 
     class Samsung_AC_Mode_Select : public select::Select
@@ -89,10 +114,47 @@ namespace esphome
       }
     };
 
+    // last known settings of a device, restored at boot until the device reports them
+    struct DeviceStatePreference
+    {
+      // tenths of a degree, INT16_MIN when unknown
+      int16_t target_temperature;
+      int16_t water_outlet_target;
+      int16_t target_water_temperature;
+      int8_t power;
+      int8_t automatic_cleaning;
+      int8_t mode;
+      int8_t fanmode;
+      int8_t water_heater_power;
+      int8_t water_heater_mode;
+    };
+
+    // read-only sensors of a device, only the configured ones take up memory
+    enum class SensorSlot : uint8_t
+    {
+      RoomTemperature,
+      OutdoorTemperature,
+      IndoorEvaInTemperature,
+      IndoorEvaOutTemperature,
+      ErrorCode,
+      OutdoorInstantaneousPower,
+      OutdoorCumulativeEnergy,
+      OutdoorCurrent,
+      OutdoorVoltage,
+      CommandLatency
+    };
+
+    struct Samsung_AC_Slot_Sensor
+    {
+      SensorSlot slot;
+      sensor::Sensor *sensor;
+    };
+
     struct Samsung_AC_Sensor
     {
       uint16_t message_number;
       sensor::Sensor *sensor;
+      ValueConverter converter;
     };
 
     class Samsung_AC_Device
@@ -101,20 +163,15 @@ namespace esphome
       Samsung_AC_Device(const std::string &address, MessageTarget *target)
       {
         this->address = address;
+        this->packed_address = pack_address(address);
         this->target = target;
         this->protocol = get_protocol(address);
       }
 
       std::string address;
-      sensor::Sensor *room_temperature{nullptr};
-      sensor::Sensor *outdoor_temperature{nullptr};
-      sensor::Sensor *indoor_eva_in_temperature{nullptr};
-      sensor::Sensor *indoor_eva_out_temperature{nullptr};
-      sensor::Sensor *error_code{nullptr};
-      sensor::Sensor *outdoor_instantaneous_power{nullptr};
-      sensor::Sensor *outdoor_cumulative_energy{nullptr};
-      sensor::Sensor *outdoor_current{nullptr};
-      sensor::Sensor *outdoor_voltage{nullptr};
+      PackedAddress packed_address;
+      // position in the device registry of the parent
+      uint8_t handle{DeviceRegistry<Samsung_AC_Device *>::invalidHandle};
       Samsung_AC_Number *target_temperature{nullptr};
       Samsung_AC_Number *water_outlet_target{nullptr};
       Samsung_AC_Number *target_water_temperature{nullptr};
@@ -124,8 +181,11 @@ namespace esphome
       Samsung_AC_Mode_Select *mode{nullptr};
       Samsung_AC_Water_Heater_Mode_Select *waterheatermode{nullptr};
       Samsung_AC_Climate *climate{nullptr};
-      std::map<uint16_t, sensor::Sensor *> custom_sensor_map;
-      float room_temperature_offset{0};
+      binary_sensor::BinarySensor *availability{nullptr};
+      // sorted by message number
+      std::vector<Samsung_AC_Sensor> custom_sensors;
+      Temperature room_temperature_offset{};
+      optional<Temperature> _cur_room_temperature;
 
       template <typename SwingType>
       void update_swing(SwingType &swing_variable, uint8_t mask, bool value)
@@ -142,80 +202,178 @@ namespace esphome
         }
       }
 
+      void update_sensor_state(sensor::Sensor *target_sensor, Temperature value)
+      {
+        if (target_sensor != nullptr)
+        {
+          target_sensor->publish_state(value.to_float());
+        }
+      }
+
+      sensor::Sensor *get_sensor(SensorSlot slot)
+      {
+        for (const auto &entry : sensors_)
+        {
+          if (entry.slot == slot)
+            return entry.sensor;
+        }
+        return nullptr;
+      }
+
+      void set_sensor(SensorSlot slot, sensor::Sensor *sensor)
+      {
+        for (auto &entry : sensors_)
+        {
+          if (entry.slot == slot)
+          {
+            entry.sensor = sensor;
+            return;
+          }
+        }
+        sensors_.push_back(Samsung_AC_Slot_Sensor{slot, sensor});
+        sensors_.shrink_to_fit();
+      }
+
+      void update_sensor_state(SensorSlot slot, float value)
+      {
+        update_sensor_state(get_sensor(slot), value);
+      }
+
+      void update_sensor_state(SensorSlot slot, Temperature value)
+      {
+        update_sensor_state(get_sensor(slot), value);
+      }
+
       void set_error_code_sensor(sensor::Sensor *sensor)
       {
-        error_code = sensor;
+        set_sensor(SensorSlot::ErrorCode, sensor);
       }
 
       void update_error_code(int value)
       {
-        if (error_code != nullptr)
-          error_code->publish_state(value);
+        update_sensor_state(SensorSlot::ErrorCode, (float)value);
       }
 
       void set_outdoor_instantaneous_power_sensor(sensor::Sensor *sensor)
       {
-        outdoor_instantaneous_power = sensor;
+        set_sensor(SensorSlot::OutdoorInstantaneousPower, sensor);
       }
 
       void set_outdoor_cumulative_energy_sensor(sensor::Sensor *sensor)
       {
-        outdoor_cumulative_energy = sensor;
+        set_sensor(SensorSlot::OutdoorCumulativeEnergy, sensor);
       }
 
       void set_outdoor_current_sensor(sensor::Sensor *sensor)
       {
-        outdoor_current = sensor;
+        set_sensor(SensorSlot::OutdoorCurrent, sensor);
       }
 
       void set_outdoor_voltage_sensor(sensor::Sensor *sensor)
       {
-        outdoor_voltage = sensor;
+        set_sensor(SensorSlot::OutdoorVoltage, sensor);
+      }
+
+      void set_command_latency_sensor(sensor::Sensor *sensor)
+      {
+        set_sensor(SensorSlot::CommandLatency, sensor);
       }
 
       void set_outdoor_temperature_sensor(sensor::Sensor *sensor)
       {
-        outdoor_temperature = sensor;
+        set_sensor(SensorSlot::OutdoorTemperature, sensor);
       }
 
       void set_indoor_eva_in_temperature_sensor(sensor::Sensor *sensor)
       {
-        indoor_eva_in_temperature = sensor;
+        set_sensor(SensorSlot::IndoorEvaInTemperature, sensor);
       }
 
       void set_indoor_eva_out_temperature_sensor(sensor::Sensor *sensor)
       {
-        indoor_eva_out_temperature = sensor;
+        set_sensor(SensorSlot::IndoorEvaOutTemperature, sensor);
       }
 
-      void update_custom_sensor(uint16_t message_number, float value)
+      void update_custom_sensor(uint16_t message_number, long value)
       {
-        auto it = custom_sensor_map.find(message_number);
-        if (it != custom_sensor_map.end())
+        if (!sync_pending_.empty())
         {
-          it->second->publish_state(value);
+          auto pending = std::lower_bound(sync_pending_.begin(), sync_pending_.end(), message_number);
+          if (pending != sync_pending_.end() && *pending == message_number)
+          {
+            sync_pending_.erase(pending);
+            if (sync_pending_.empty())
+              ESP_LOGD(TAG, "Device %s synced after %u ms", address.c_str(), millis() - sync_started_);
+          }
         }
+
+        auto it = find_custom_sensor(message_number);
+        if (it != custom_sensors.end() && it->message_number == message_number)
+          it->sensor->publish_state(it->converter.apply(value));
+      }
+
+      void set_availability_sensor(binary_sensor::BinarySensor *sensor)
+      {
+        availability = sensor;
+      }
+
+      void update_availability(bool online)
+      {
+        if (availability != nullptr)
+          availability->publish_state(online);
+      }
+
+      // publishes unknown values for everything the unit reports, called when it went offline
+      void mark_unavailable();
+
+      void mark_available()
+      {
+        unavailable_ = false;
+      }
+
+      bool is_unavailable()
+      {
+        return unavailable_;
       }
 
       void set_room_temperature_sensor(sensor::Sensor *sensor)
       {
-        room_temperature = sensor;
+        set_sensor(SensorSlot::RoomTemperature, sensor);
       }
 
-      void update_room_temperature(float value)
+      void update_room_temperature(Temperature value)
       {
-        if (room_temperature != nullptr)
-          room_temperature->publish_state(value + room_temperature_offset);
-        if (climate != nullptr)
+        value.tenths += room_temperature_offset.tenths;
+        update_sensor_state(SensorSlot::RoomTemperature, value);
+
+        // the whole climate state is sent on publish, skip it when nothing changed
+        if (climate != nullptr && _cur_room_temperature != value)
         {
-          climate->current_temperature = value + room_temperature_offset;
+          climate->current_temperature = value.to_float();
           climate->publish_state();
         }
+        _cur_room_temperature = value;
       }
 
       void add_custom_sensor(int message_number, sensor::Sensor *sensor)
       {
-        custom_sensor_map[(uint16_t)message_number] = sensor;
+        add_custom_sensor(message_number, sensor, ValueType::Unsigned, 1, 0);
+      }
+
+      void add_custom_sensor(int message_number, sensor::Sensor *sensor, ValueType type, float multiply, float offset)
+      {
+        Samsung_AC_Sensor entry{(uint16_t)message_number, sensor, ValueConverter{type, multiply, offset}};
+        auto it = find_custom_sensor(entry.message_number);
+        if (it != custom_sensors.end() && it->message_number == entry.message_number)
+          *it = entry;
+        else
+          custom_sensors.insert(it, entry);
+      }
+
+      void add_poll_message(int message_number, uint32_t interval)
+      {
+        if (protocol != nullptr)
+          protocol->add_poll_message(address, (uint16_t)message_number, interval);
       }
 
       void set_power_switch(Samsung_AC_Switch *switch_)
@@ -280,7 +438,7 @@ namespace esphome
         {
           ProtocolRequest request;
           request.target_temp = value;
-          publish_request(request);
+          publish_request(request, target_temperature->debounce);
         };
       };
 
@@ -291,7 +449,7 @@ namespace esphome
         {
           ProtocolRequest request;
           request.water_outlet_target = value;
-          publish_request(request);
+          publish_request(request, water_outlet_target->debounce);
         };
       };
 
@@ -302,7 +460,7 @@ namespace esphome
         {
           ProtocolRequest request;
           request.target_water_temp = value;
-          publish_request(request);
+          publish_request(request, target_water_temperature->debounce);
         };
       };
 
@@ -310,29 +468,39 @@ namespace esphome
       {
         climate = value;
         climate->device = this;
+        climate->update_traits();
       }
 
-      void update_target_temperature(float value)
+      void update_target_temperature(Temperature value)
       {
+        if (!accept_report(ControlField::TargetTemperature, value.tenths))
+          return;
+        _cur_target_temperature = value;
         if (target_temperature != nullptr)
-          target_temperature->publish_state(value);
+          target_temperature->publish_state(value.to_float());
         if (climate != nullptr)
         {
-          climate->target_temperature = value;
+          climate->target_temperature = value.to_float();
           climate->publish_state();
         }
       }
 
-      void update_water_outlet_target(float value)
+      void update_water_outlet_target(Temperature value)
       {
+        if (!accept_report(ControlField::WaterOutletTarget, value.tenths))
+          return;
+        _cur_water_outlet_target = value;
         if (water_outlet_target != nullptr)
-          water_outlet_target->publish_state(value);
+          water_outlet_target->publish_state(value.to_float());
       }
 
-      void update_target_water_temperature(float value)
+      void update_target_water_temperature(Temperature value)
       {
+        if (!accept_report(ControlField::TargetWaterTemperature, value.tenths))
+          return;
+        _cur_target_water_temperature = value;
         if (target_water_temperature != nullptr)
-          target_water_temperature->publish_state(value);
+          target_water_temperature->publish_state(value.to_float());
       }
 
       optional<bool> _cur_power;
@@ -340,9 +508,15 @@ namespace esphome
       optional<bool> _cur_water_heater_power;
       optional<Mode> _cur_mode;
       optional<WaterHeaterMode> _cur_water_heater_mode;
+      optional<FanMode> _cur_fanmode;
+      optional<Temperature> _cur_target_temperature;
+      optional<Temperature> _cur_water_outlet_target;
+      optional<Temperature> _cur_target_water_temperature;
 
       void update_power(bool value)
       {
+        if (!accept_report(ControlField::Power, value))
+          return;
         _cur_power = value;
         if (power != nullptr)
           power->publish_state(value);
@@ -352,6 +526,8 @@ namespace esphome
 
       void update_automatic_cleaning(bool value)
       {
+        if (!accept_report(ControlField::AutomaticCleaning, value))
+          return;
         _cur_automatic_cleaning = value;
         if (automatic_cleaning != nullptr)
           automatic_cleaning->publish_state(value);
@@ -361,6 +537,8 @@ namespace esphome
 
       void update_water_heater_power(bool value)
       {
+        if (!accept_report(ControlField::WaterHeaterPower, value))
+          return;
         _cur_water_heater_power = value;
         if (water_heater_power != nullptr)
           water_heater_power->publish_state(value);
@@ -368,6 +546,8 @@ namespace esphome
 
       void update_mode(Mode value)
       {
+        if (!accept_report(ControlField::Mode, (long)value))
+          return;
         _cur_mode = value;
         if (mode != nullptr)
           mode->publish_state_(value);
@@ -377,6 +557,8 @@ namespace esphome
 
       void update_water_heater_mode(WaterHeaterMode value)
       {
+        if (!accept_report(ControlField::WaterHeaterMode, (long)value))
+          return;
         _cur_water_heater_mode = value;
         if (waterheatermode != nullptr)
           waterheatermode->publish_state_(value);
@@ -384,6 +566,9 @@ namespace esphome
 
       void update_fanmode(FanMode value)
       {
+        if (!accept_report(ControlField::FanMode, (long)value))
+          return;
+        _cur_fanmode = value;
         if (climate != nullptr)
         {
           climate->apply_fanmode_from_device(value);
@@ -393,6 +578,8 @@ namespace esphome
 
       void update_altmode(AltMode value)
       {
+        if (!accept_report(ControlField::AltMode, value))
+          return;
         if (climate != nullptr)
         {
           auto supported = get_supported_alt_modes();
@@ -412,6 +599,8 @@ namespace esphome
 
       void update_swing_vertical(bool value)
       {
+        if (!accept_report(ControlField::SwingVertical, value))
+          return;
         if (climate != nullptr)
         {
           update_swing(climate->swing_mode, 1, value);
@@ -420,6 +609,8 @@ namespace esphome
 
       void update_swing_horizontal(bool value)
       {
+        if (!accept_report(ControlField::SwingHorizontal, value))
+          return;
         if (climate != nullptr)
         {
           update_swing(climate->swing_mode, 2, value);
@@ -428,9 +619,27 @@ namespace esphome
 
       void publish_request(ProtocolRequest &request)
       {
+        if (passive_mode)
+        {
+          ESP_LOGW(TAG, "Passive mode, ignoring control of %s", address.c_str());
+          return;
+        }
         protocol->publish_request(target, address, request);
+        publish_optimistic(request);
       }
 
+      // publishes the requested values right away, the reports of the unit confirm them later.
+      // also used for group requests, which are sent for many devices at once. A debounced value
+      // of the same field which was not sent yet is dropped, the newer value wins.
+      void publish_optimistic(const ProtocolRequest &request);
+
+      // the temperatures are sent once they did not change for debounce ms, each with its own window.
+      // they are published right away nevertheless. The other values are sent right away.
+      void publish_request(ProtocolRequest &request, uint32_t debounce);
+
+      // sends the debounced values whose window passed
+      void flush_debounced(uint32_t now);
+
       bool supports_horizontal_swing()
       {
         return supports_horizontal_swing_;
@@ -444,11 +653,15 @@ namespace esphome
       void set_supports_horizontal_swing(bool value)
       {
         supports_horizontal_swing_ = value;
+        if (climate != nullptr)
+          climate->update_traits();
       }
 
       void set_supports_vertical_swing(bool value)
       {
         supports_vertical_swing_ = value;
+        if (climate != nullptr)
+          climate->update_traits();
       }
 
       void add_alt_mode(const AltModeName &name, AltMode value)
@@ -457,6 +670,9 @@ namespace esphome
         desc.name = name;
         desc.value = value;
         alt_modes.push_back(std::move(desc));
+        // custom presets point into alt_modes, which may just have been reallocated
+        if (climate != nullptr)
+          climate->update_traits();
       }
 
       const std::vector<AltModeDesc> *get_supported_alt_modes()
@@ -466,9 +682,35 @@ namespace esphome
 
       void set_room_temperature_offset(float value)
       {
-        room_temperature_offset = value;
+        room_temperature_offset = Temperature::from_tenths(lroundf(value * 10));
+      }
+
+      // publishes the settings stored before the last reboot
+      void restore_state();
+
+      // stores the current settings, flash is only written when they changed
+      void save_state();
+
+      // collects the messages of all configured entities which have to be received after boot
+      void start_sync();
+
+      // asks the device for all messages which were not received yet
+      void request_sync()
+      {
+        for (uint16_t message_number : sync_pending_)
+        {
+          protocol->request_read(address, message_number);
+        }
+      }
+
+      bool is_synced()
+      {
+        return sync_pending_.empty();
       }
 
+      // heap and object memory used by this device, without the entities themselves
+      size_t memory_usage();
+
       void protocol_update(MessageTarget *target)
       {
         if (protocol != nullptr)
@@ -480,7 +722,47 @@ namespace esphome
     protected:
       bool supports_horizontal_swing_{false};
       bool supports_vertical_swing_{false};
+      bool unavailable_{false};
+      PendingCommands pending_;
+
+      // a debounced value which was not sent yet, one per debounced field of ProtocolRequest
+      struct DebouncedValue
+      {
+        optional<float> value;
+        uint32_t since{0};
+        uint32_t window{0};
+      };
+      std::array<DebouncedValue, 3> debounced_;
+
+      // the unit gets the full confirm timeout from when a debounced request is actually sent
+      void restart_pending(const ProtocolRequest &request, uint32_t now);
+
+      // false if the value reported by the unit is older than a command which is still pending
+      bool accept_report(ControlField field, long value);
+
+      template <typename Func>
+      void command_field(ControlField field, long value, Func publish)
+      {
+        // a pending command for this field would suppress the new value
+        pending_.cancel(field);
+        publish();
+        pending_.command(field, value, millis());
+      }
       std::vector<AltModeDesc> alt_modes;
+      std::vector<Samsung_AC_Slot_Sensor> sensors_;
+      // sorted, usually empty shortly after boot
+      std::vector<uint16_t> sync_pending_;
+      uint32_t sync_started_ = 0;
+
+      std::vector<Samsung_AC_Sensor>::iterator find_custom_sensor(uint16_t message_number)
+      {
+        return std::lower_bound(custom_sensors.begin(), custom_sensors.end(), message_number, [](const Samsung_AC_Sensor &entry, uint16_t value)
+                                { return entry.message_number < value; });
+      }
+
+      DeviceStatePreference current_state();
+      ESPPreferenceObject state_pref_;
+      DeviceStatePreference saved_state_{};
 
       Protocol *protocol{nullptr};
       MessageTarget *target{nullptr};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace esphome
+{
+    namespace samsung_ac
+    {
+        // Lock-free byte ring for exactly one producer and one consumer thread.
+        //
+        // The producer stages bytes with write() and makes them visible with commit(), the
+        // consumer reads them with read() and frees the space with release(). So a record made
+        // of several writes is only seen by the consumer once it is complete. head_ and tail_
+        // count all bytes ever committed/released, they are only masked to index the buffer.
+        template <size_t Capacity>
+        class SpscRing
+        {
+            static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+        public:
+            // producer: space for staging, the consumer might free more in the meantime
+            size_t writable() const
+            {
+                return Capacity - (staged_ - tail_.load(std::memory_order_acquire));
+            }
+
+            // producer: the caller checks writable() first
+            void write(const uint8_t *data, size_t length)
+            {
+                for (size_t i = 0; i < length; i++)
+                    buffer_[(staged_ + i) & (Capacity - 1)] = data[i];
+                staged_ += length;
+            }
+
+            void commit()
+            {
+                head_.store(staged_, std::memory_order_release);
+            }
+
+            // consumer: committed bytes which were not read yet
+            size_t readable() const
+            {
+                return head_.load(std::memory_order_acquire) - read_;
+            }
+
+            // consumer: the caller checks readable() first
+            void read(uint8_t *data, size_t length)
+            {
+                for (size_t i = 0; i < length; i++)
+                    data[i] = buffer_[(read_ + i) & (Capacity - 1)];
+                read_ += length;
+            }
+
+            void release()
+            {
+                tail_.store(read_, std::memory_order_release);
+            }
+
+        protected:
+            // producer and consumer side on separate cache lines, they are written by different cores
+            alignas(64) std::atomic<size_t> head_{0};
+            size_t staged_ = 0;
+            alignas(64) std::atomic<size_t> tail_{0};
+            size_t read_ = 0;
+            alignas(64) uint8_t buffer_[Capacity];
+        };
+    } // namespace samsung_ac
+} // namespace esphome
@@ -0,0 +1,7 @@
+echo ==== BUILDING tools ====
+# the tools are not run by the tests, building them catches link errors of the protocol hal
+g++ test/main_capture_index.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp -Itest -o tool.exe
+g++ test/main_capture_query.cpp components/samsung_ac/util.cpp -Itest -o tool.exe
+g++ test/main_decode_capture.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp -Itest -pthread -o tool.exe
+g++ test/main_export_series.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp -Itest -pthread -o tool.exe
+g++ test/main_query_series.cpp components/samsung_ac/util.cpp -Itest -o tool.exe
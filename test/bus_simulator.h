@@ -0,0 +1,395 @@
+#pragma once
+
+#include <map>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "virtual_clock.h"
+#include "frame_splitter.h"
+#include "../components/samsung_ac/util.h"
+#include "../components/samsung_ac/protocol_nasa.h"
+#include "../components/samsung_ac/protocol_non_nasa.h"
+
+using namespace esphome::samsung_ac;
+
+struct BusSimulatorOptions
+{
+    bool nasa = true;
+    unsigned indoor_units = 1;
+    float crc_error_rate = 0;  // share of frames with a flipped payload byte
+    float collision_rate = 0;  // share of frames cut off by another sender
+    uint32_t ack_latency = 50; // time a unit needs to answer a command
+    uint32_t seed = 1;
+};
+
+struct BusSimulatorStats
+{
+    uint64_t frames_sent = 0;       // frames of the simulated units
+    uint64_t crc_errors = 0;        // ... which were corrupted
+    uint64_t collisions = 0;        // ... which were cut off
+    uint64_t frames_received = 0;   // valid frames of the component
+    uint64_t commands_received = 0; // ... which control a unit, including resends
+    uint64_t commands_applied = 0;  // ... which changed a unit
+    uint64_t acks_sent = 0;
+};
+
+// Simulated outdoor unit with indoor units on a NASA or NonNASA bus, driven by a VirtualClock.
+//
+// NASA: indoor units 20.00.xx notify their state every 3 s, the outdoor unit 10.00.00 every
+// second. Requests and writes are acked and applied, reads are answered with a response.
+// NonNASA: indoor units 00.. send Cmd20 every second. Once a controller registered, the outdoor
+// unit c8 offers a request_control (C6) window every second. Control frames are acked with
+// Cmd54 and show up in the next Cmd20.
+//
+// update() returns the frames the units put on the bus until now, receive() takes the bytes of
+// the component, so the simulator can be wired to a VirtualTarget or a pseudo-terminal.
+class BusSimulator
+{
+public:
+    struct Unit
+    {
+        std::string address;
+        uint32_t next_status;
+        std::map<uint16_t, long> values; // NASA message number -> value
+
+        // NonNASA state
+        uint8_t target_temp = 22;
+        uint8_t room_temp = 24;
+        uint8_t fanspeed = 0;
+        uint8_t mode = (uint8_t)NonNasaMode::Cool;
+        bool power = false;
+
+        uint32_t last_command = 0; // time the last command was applied
+    };
+
+    BusSimulator(const BusSimulatorOptions &options, VirtualClock &clock = VirtualClock::instance())
+        : options_(options), clock_(clock), random_(options.seed)
+    {
+        const uint32_t now = clock_.now();
+        for (unsigned i = 0; i < options_.indoor_units; i++)
+        {
+            Unit unit;
+            char address[9];
+            if (options_.nasa)
+                snprintf(address, sizeof(address), "20.00.%02x", (uint8_t)i);
+            else
+                snprintf(address, sizeof(address), "%02x", (uint8_t)i);
+            unit.address = address;
+            unit.next_status = now + (options_.nasa ? 3000 : 1000) * i / options_.indoor_units;
+            unit.values[(uint16_t)MessageNumber::ENUM_in_operation_power] = 0;
+            unit.values[(uint16_t)MessageNumber::ENUM_in_operation_mode] = 1;
+            unit.values[(uint16_t)MessageNumber::ENUM_in_fan_mode] = 0;
+            unit.values[(uint16_t)MessageNumber::VAR_in_temp_target_f] = 220;
+            unit.values[(uint16_t)MessageNumber::VAR_in_temp_room_f] = 240 + i % 10;
+            units_.push_back(unit);
+        }
+
+        outdoor_.address = options_.nasa ? "10.00.00" : "c8";
+        outdoor_.next_status = now;
+        outdoor_.values[(uint16_t)MessageNumber::VAR_out_sensor_airout] = 105;
+        outdoor_.values[(uint16_t)MessageNumber::VAR_out_error_code] = 0;
+    }
+
+    const BusSimulatorStats &stats() const
+    {
+        return stats_;
+    }
+
+    std::vector<Unit> &units()
+    {
+        return units_;
+    }
+
+    Unit *find_unit(const std::string &address)
+    {
+        for (auto &unit : units_)
+        {
+            if (unit.address == address)
+                return &unit;
+        }
+        return nullptr;
+    }
+
+    // appends all frames which are due until now, each as it would arrive on the bus
+    void update(std::vector<std::vector<uint8_t>> &frames)
+    {
+        const uint32_t now = clock_.now();
+
+        if (options_.nasa)
+        {
+            if (due(outdoor_.next_status, now))
+            {
+                queue(now, nasa_notification(outdoor_));
+                outdoor_.next_status += 1000;
+            }
+            for (auto &unit : units_)
+            {
+                if (due(unit.next_status, now))
+                {
+                    queue(now, nasa_notification(unit));
+                    unit.next_status += 3000;
+                }
+            }
+        }
+        else
+        {
+            if (due(outdoor_.next_status, now))
+            {
+                // outdoor data, and the control window for a registered controller
+                queue(now, non_nasa_frame(0xc8, 0xad, 0xc0, 0));
+                if (controller_registered_)
+                    queue(now, non_nasa_frame(0xc8, 0xd0, 0xc6, 1));
+                outdoor_.next_status += 1000;
+            }
+            for (auto &unit : units_)
+            {
+                if (due(unit.next_status, now))
+                {
+                    queue(now, non_nasa_status(unit));
+                    unit.next_status += 1000;
+                }
+            }
+        }
+
+        std::stable_sort(pending_.begin(), pending_.end(), [](const Pending &a, const Pending &b)
+                         { return (int32_t)(a.time - b.time) < 0; });
+        while (!pending_.empty() && due(pending_.front().time, now))
+        {
+            frames.push_back(emit(std::move(pending_.front().data)));
+            pending_.pop_front();
+        }
+    }
+
+    // appends the bytes of all frames which are due until now
+    void update(std::vector<uint8_t> &out)
+    {
+        std::vector<std::vector<uint8_t>> frames;
+        update(frames);
+        for (const auto &frame : frames)
+            out.insert(out.end(), frame.begin(), frame.end());
+    }
+
+    // bytes written by the component, may contain partial frames
+    void receive(const uint8_t *data, size_t size)
+    {
+        input_.insert(input_.end(), data, data + size);
+        while (!input_.empty())
+        {
+            // an incomplete frame waits for the rest
+            int length = frame_length(input_.data(), input_.size());
+            if (length == 0)
+                return;
+            if (length < 0)
+            {
+                input_.erase(input_.begin(), input_.begin() - length);
+                continue;
+            }
+
+            std::vector<uint8_t> frame(input_.begin(), input_.begin() + length);
+            input_.erase(input_.begin(), input_.begin() + length);
+            stats_.frames_received++;
+            if (options_.nasa)
+                handle_nasa(frame);
+            else
+                handle_non_nasa(frame);
+        }
+    }
+
+    void receive(const std::vector<uint8_t> &data)
+    {
+        receive(data.data(), data.size());
+    }
+
+protected:
+    struct Pending
+    {
+        uint32_t time;
+        std::vector<uint8_t> data;
+    };
+
+    static bool due(uint32_t time, uint32_t now)
+    {
+        return (int32_t)(now - time) >= 0;
+    }
+
+    void queue(uint32_t time, std::vector<uint8_t> &&data)
+    {
+        pending_.push_back(Pending{time, std::move(data)});
+    }
+
+    bool chance(float rate)
+    {
+        return rate > 0 && std::uniform_real_distribution<float>(0, 1)(random_) < rate;
+    }
+
+    std::vector<uint8_t> emit(std::vector<uint8_t> frame)
+    {
+        stats_.frames_sent++;
+        if (chance(options_.crc_error_rate))
+        {
+            stats_.crc_errors++;
+            size_t index = std::uniform_int_distribution<size_t>(3, frame.size() - 4)(random_);
+            frame[index] ^= 1 << std::uniform_int_distribution<int>(0, 7)(random_);
+        }
+        if (chance(options_.collision_rate))
+        {
+            stats_.collisions++;
+            frame.resize(std::uniform_int_distribution<size_t>(1, frame.size() - 1)(random_));
+        }
+        return frame;
+    }
+
+    std::vector<uint8_t> nasa_notification(const Unit &unit)
+    {
+        Packet packet = Packet::createa_partial(Address::parse("b0.ff.20"), DataType::Notification);
+        packet.sa = Address::parse(unit.address);
+        for (const auto &value : unit.values)
+        {
+            MessageSet message((MessageNumber)value.first);
+            message.value = value.second;
+            packet.messages.push_back(message);
+        }
+        return packet.encode();
+    }
+
+    void handle_nasa(std::vector<uint8_t> &frame)
+    {
+        Packet packet;
+        if (packet.decode(frame).type != DecodeResultType::Processed)
+            return;
+
+        const std::string da = packet.da.to_string();
+        Unit *unit = da == outdoor_.address ? &outdoor_ : find_unit(da);
+        if (unit == nullptr)
+            return;
+
+        const uint32_t answer = clock_.now() + options_.ack_latency;
+        Packet reply = Packet::createa_partial(packet.sa, DataType::Ack);
+        reply.sa = packet.da;
+        reply.command.packetNumber = packet.command.packetNumber;
+
+        switch (packet.command.dataType)
+        {
+        case DataType::Request:
+        case DataType::Write:
+        {
+            stats_.commands_received++;
+            bool changed = false;
+            for (const auto &message : packet.messages)
+            {
+                long &value = unit->values[(uint16_t)message.messageNumber];
+                changed |= value != message.value;
+                value = message.value;
+            }
+            if (changed)
+            {
+                unit->last_command = clock_.now();
+                stats_.commands_applied++;
+            }
+            stats_.acks_sent++;
+            queue(answer, reply.encode());
+            // units report the new state right away
+            unit->next_status = answer + 100;
+            break;
+        }
+        case DataType::Read:
+            reply.command.dataType = DataType::Response;
+            for (const auto &message : packet.messages)
+            {
+                MessageSet answer_message(message.messageNumber);
+                auto it = unit->values.find((uint16_t)message.messageNumber);
+                answer_message.value = it != unit->values.end() ? it->second : 0;
+                reply.messages.push_back(answer_message);
+            }
+            queue(answer, reply.encode());
+            break;
+        default:
+            break;
+        }
+    }
+
+    static std::vector<uint8_t> non_nasa_frame(uint8_t src, uint8_t dst, uint8_t cmd, uint8_t data4)
+    {
+        NonNasaFrame frame(src, dst, cmd);
+        frame.set(4, data4);
+        return frame.to_vector();
+    }
+
+    static std::vector<uint8_t> non_nasa_status(const Unit &unit)
+    {
+        NonNasaFrame frame((uint8_t)hex_to_int(unit.address), 0xc8, 0x20);
+        frame.set(4, unit.target_temp + 55);
+        frame.set(5, unit.room_temp + 55);
+        frame.set(6, unit.room_temp - 2 + 55);
+        frame.set(7, (uint8_t)NonNasaWindDirection::Stop << 3 | unit.fanspeed);
+        frame.set(8, unit.mode | (unit.power ? 0x80 : 0));
+        frame.set(11, unit.room_temp - 4 + 55);
+        return frame.to_vector();
+    }
+
+    static uint8_t decode_fanspeed(uint8_t bits)
+    {
+        switch (bits)
+        {
+        case 64:
+            return (uint8_t)NonNasaFanspeed::Low;
+        case 128:
+            return (uint8_t)NonNasaFanspeed::Medium;
+        case 160:
+            return (uint8_t)NonNasaFanspeed::High;
+        default:
+            return (uint8_t)NonNasaFanspeed::Auto;
+        }
+    }
+
+    void handle_non_nasa(std::vector<uint8_t> &frame)
+    {
+        const uint8_t cmd = frame[3];
+        if (cmd == 0xD1)
+        {
+            // register_device, the outdoor unit starts offering control windows
+            controller_registered_ = true;
+            return;
+        }
+        if (cmd != 0xB0)
+            return;
+        stats_.commands_received++;
+
+        Unit *unit = find_unit(long_to_hex(frame[2]));
+        if (unit == nullptr)
+            return;
+
+        // the inverse of NonNasaRequest::encode_frame
+        static const uint8_t modes[] = {(uint8_t)NonNasaMode::Auto, (uint8_t)NonNasaMode::Cool, (uint8_t)NonNasaMode::Dry,
+                                        (uint8_t)NonNasaMode::Fan, (uint8_t)NonNasaMode::Heat};
+        uint8_t target_temp = frame[6] & 31;
+        uint8_t fanspeed = decode_fanspeed(frame[6] & 0xE0);
+        uint8_t mode = frame[7] < sizeof(modes) ? modes[frame[7]] : (uint8_t)NonNasaMode::Auto;
+        bool power = (frame[8] & 0xF0) == 0xF0;
+
+        if (unit->target_temp != target_temp || unit->fanspeed != fanspeed || unit->mode != mode || unit->power != power)
+        {
+            unit->target_temp = target_temp;
+            unit->fanspeed = fanspeed;
+            unit->mode = mode;
+            unit->power = power;
+            unit->last_command = clock_.now();
+            stats_.commands_applied++;
+        }
+
+        stats_.acks_sent++;
+        queue(clock_.now() + options_.ack_latency, non_nasa_frame(frame[2], 0xd0, 0x54, frame[4]));
+    }
+
+    BusSimulatorOptions options_;
+    VirtualClock &clock_;
+    std::mt19937 random_;
+    std::vector<Unit> units_;
+    Unit outdoor_;
+    std::deque<Pending> pending_;
+    std::vector<uint8_t> input_;
+    bool controller_registered_ = false;
+    BusSimulatorStats stats_;
+};
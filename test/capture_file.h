@@ -0,0 +1,251 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "../components/samsung_ac/capture.h"
+
+using namespace esphome::samsung_ac;
+
+// Read only file contents, memory-mapped on Linux and read into memory elsewhere.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    bool open(const std::string &path)
+    {
+        close();
+#ifdef __linux__
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+                data_ = (const uint8_t *)mapped;
+                size_ = st.st_size;
+            }
+        }
+        ::close(fd);
+#else
+        std::ifstream file(path, std::ios::binary);
+        buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (!buffer_.empty())
+            data_ = buffer_.data();
+        size_ = buffer_.size();
+#endif
+        return data_ != nullptr;
+    }
+
+    void close()
+    {
+#ifdef __linux__
+        if (data_ != nullptr)
+            munmap((void *)data_, size_);
+#endif
+        buffer_.clear();
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const uint8_t *data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+protected:
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<uint8_t> buffer_;
+};
+
+// Read only view of a capture file (see capture.h). Since the file is mapped, even large
+// captures open instantly and index lookups only touch the pages they need.
+class CaptureFile
+{
+public:
+    bool open(const std::string &path)
+    {
+        close();
+        if (!file_.open(path) || !is_capture_header(file_.data(), file_.size()))
+        {
+            close();
+            return false;
+        }
+
+        data_ = file_.data();
+        records_end_ = file_.size();
+        if (parse_capture_trailer(data_, file_.size(), index_offset_, index_entries_))
+            records_end_ = index_offset_;
+        else
+            index_entries_ = 0;
+        return true;
+    }
+
+    void close()
+    {
+        file_.close();
+        data_ = nullptr;
+        records_end_ = 0;
+        index_offset_ = 0;
+        index_entries_ = 0;
+    }
+
+    bool has_index() const
+    {
+        return index_entries_ > 0;
+    }
+
+    const uint8_t *data() const
+    {
+        return data_;
+    }
+
+    // file position after the last record
+    size_t records_end() const
+    {
+        return records_end_;
+    }
+
+    // calls f(offset, record) for every record, stops early if f returns false
+    template <typename F>
+    void for_each(F f) const
+    {
+        CaptureRecord record;
+        size_t offset = captureHeaderSize;
+        while (size_t length = parse_capture_record(data_ + offset, records_end_ - offset, record))
+        {
+            if (!f((uint64_t)offset, record))
+                return;
+            offset += length;
+        }
+    }
+
+    bool record_at(uint64_t offset, CaptureRecord &record) const
+    {
+        if (offset < captureHeaderSize || offset >= records_end_)
+            return false;
+        return parse_capture_record(data_ + offset, records_end_ - offset, record) > 0;
+    }
+
+    // offsets of all records of source which contain message (or all of them for
+    // captureAnyMessage), using the index when there is one
+    std::vector<uint64_t> find(uint32_t source, uint16_t message) const
+    {
+        std::vector<uint64_t> offsets;
+        if (!has_index())
+            return offsets;
+
+        const uint8_t *index = data_ + index_offset_;
+        size_t first = 0;
+        size_t count = index_entries_;
+        while (count > 0)
+        {
+            size_t step = count / 2;
+            CaptureIndexEntry entry = read_capture_index_entry(index + (first + step) * captureIndexEntrySize);
+            if (entry.source < source || (entry.source == source && entry.message < message))
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+                count = step;
+        }
+
+        for (size_t i = first; i < index_entries_; i++)
+        {
+            CaptureIndexEntry entry = read_capture_index_entry(index + i * captureIndexEntrySize);
+            if (entry.source != source || entry.message != message)
+                break;
+            offsets.push_back(entry.offset);
+        }
+        return offsets;
+    }
+
+protected:
+    MappedFile file_;
+    const uint8_t *data_ = nullptr;
+    size_t records_end_ = 0;
+    uint64_t index_offset_ = 0;
+    uint32_t index_entries_ = 0;
+};
+
+// Writes a capture file record by record and collects the index entries, which are appended
+// by close(). The final size is unknown while writing, so the file is written with a stream.
+class CaptureFileWriter
+{
+public:
+    bool open(const std::string &path)
+    {
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        if (!file_)
+            return false;
+
+        std::vector<uint8_t> header;
+        append_capture_header(header);
+        file_.write((const char *)header.data(), header.size());
+        offset_ = header.size();
+        entries_.clear();
+        return true;
+    }
+
+    // returns the file position of the record, to be passed to index()
+    uint64_t add(uint32_t time, CaptureDirection direction, const uint8_t *data, uint16_t length)
+    {
+        record_.clear();
+        append_capture_record(record_, time, direction, data, length);
+        file_.write((const char *)record_.data(), record_.size());
+
+        uint64_t offset = offset_;
+        offset_ += record_.size();
+        return offset;
+    }
+
+    void index(uint32_t source, uint16_t message, uint64_t offset)
+    {
+        entries_.push_back(CaptureIndexEntry{source, message, offset});
+    }
+
+    bool close()
+    {
+        if (!entries_.empty())
+        {
+            std::vector<uint8_t> index;
+            append_capture_index(index, entries_, offset_);
+            file_.write((const char *)index.data(), index.size());
+        }
+        file_.close();
+        return !file_.fail();
+    }
+
+protected:
+    std::ofstream file_;
+    uint64_t offset_ = 0;
+    std::vector<uint8_t> record_;
+    std::vector<CaptureIndexEntry> entries_;
+};
@@ -0,0 +1,2 @@
+g++ test/main_capture_index.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp -Itest -o capture_index
+./capture_index "$@"
\ No newline at end of file
@@ -0,0 +1,2 @@
+g++ test/main_capture_query.cpp components/samsung_ac/util.cpp -Itest -o capture_query
+./capture_query "$@"
\ No newline at end of file
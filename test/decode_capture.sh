@@ -0,0 +1,2 @@
+g++ -O2 test/main_decode_capture.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp -Itest -pthread -o decode_capture
+./decode_capture "$@"
\ No newline at end of file
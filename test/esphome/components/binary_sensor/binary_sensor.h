@@ -0,0 +1,22 @@
+#pragma once
+// Fake BinarySensor for Local Testing
+
+#include "esphome/core/entity_base.h"
+
+namespace esphome
+{
+    namespace binary_sensor
+    {
+        class BinarySensor : public EntityBase
+        {
+        public:
+            void publish_state(bool state)
+            {
+                this->state = state;
+                publish_host_state(state ? "ON" : "OFF");
+            }
+
+            bool state{false};
+        };
+    } // namespace binary_sensor
+} // namespace esphome
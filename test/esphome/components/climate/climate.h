@@ -0,0 +1,264 @@
+#pragma once
+// Fake Climate for Local Testing
+
+#include <cmath>
+#include <set>
+#include <string>
+#include <vector>
+#include "esphome/core/entity_base.h"
+#include "esphome/core/optional.h"
+
+namespace esphome
+{
+    namespace climate
+    {
+        enum ClimateMode : uint8_t
+        {
+            CLIMATE_MODE_OFF = 0,
+            CLIMATE_MODE_HEAT_COOL = 1,
+            CLIMATE_MODE_COOL = 2,
+            CLIMATE_MODE_HEAT = 3,
+            CLIMATE_MODE_FAN_ONLY = 4,
+            CLIMATE_MODE_DRY = 5,
+            CLIMATE_MODE_AUTO = 6,
+        };
+
+        enum ClimateFanMode : uint8_t
+        {
+            CLIMATE_FAN_ON = 0,
+            CLIMATE_FAN_OFF = 1,
+            CLIMATE_FAN_AUTO = 2,
+            CLIMATE_FAN_LOW = 3,
+            CLIMATE_FAN_MEDIUM = 4,
+            CLIMATE_FAN_HIGH = 5,
+            CLIMATE_FAN_MIDDLE = 6,
+            CLIMATE_FAN_FOCUS = 7,
+            CLIMATE_FAN_DIFFUSE = 8,
+            CLIMATE_FAN_QUIET = 9,
+        };
+
+        enum ClimateSwingMode : uint8_t
+        {
+            CLIMATE_SWING_OFF = 0,
+            CLIMATE_SWING_BOTH = 1,
+            CLIMATE_SWING_VERTICAL = 2,
+            CLIMATE_SWING_HORIZONTAL = 3,
+        };
+
+        enum ClimatePreset : uint8_t
+        {
+            CLIMATE_PRESET_NONE = 0,
+            CLIMATE_PRESET_HOME = 1,
+            CLIMATE_PRESET_AWAY = 2,
+            CLIMATE_PRESET_BOOST = 3,
+            CLIMATE_PRESET_COMFORT = 4,
+            CLIMATE_PRESET_ECO = 5,
+            CLIMATE_PRESET_SLEEP = 6,
+            CLIMATE_PRESET_ACTIVITY = 7,
+        };
+
+        enum ClimateFeature : uint32_t
+        {
+            CLIMATE_SUPPORTS_CURRENT_TEMPERATURE = 1 << 0,
+            CLIMATE_SUPPORTS_TWO_POINT_TARGET_TEMPERATURE = 1 << 1,
+            CLIMATE_SUPPORTS_ACTION = 1 << 3,
+        };
+
+        inline const char *climate_mode_to_string(ClimateMode mode)
+        {
+            static const char *names[] = {"OFF", "HEAT_COOL", "COOL", "HEAT", "FAN_ONLY", "DRY", "AUTO"};
+            return mode <= CLIMATE_MODE_AUTO ? names[mode] : "UNKNOWN";
+        }
+
+        inline const char *climate_fan_mode_to_string(ClimateFanMode mode)
+        {
+            static const char *names[] = {"ON", "OFF", "AUTO", "LOW", "MEDIUM", "HIGH", "MIDDLE", "FOCUS", "DIFFUSE", "QUIET"};
+            return mode <= CLIMATE_FAN_QUIET ? names[mode] : "UNKNOWN";
+        }
+
+        inline const char *climate_swing_mode_to_string(ClimateSwingMode mode)
+        {
+            static const char *names[] = {"OFF", "BOTH", "VERTICAL", "HORIZONTAL"};
+            return mode <= CLIMATE_SWING_HORIZONTAL ? names[mode] : "UNKNOWN";
+        }
+
+        inline const char *climate_preset_to_string(ClimatePreset preset)
+        {
+            static const char *names[] = {"NONE", "HOME", "AWAY", "BOOST", "COMFORT", "ECO", "SLEEP", "ACTIVITY"};
+            return preset <= CLIMATE_PRESET_ACTIVITY ? names[preset] : "UNKNOWN";
+        }
+
+        class ClimateTraits
+        {
+        public:
+            void add_feature_flags(uint32_t flags) { feature_flags_ |= flags; }
+            bool has_feature_flags(uint32_t flags) const { return (feature_flags_ & flags) == flags; }
+
+            void set_visual_temperature_step(float step) { visual_temperature_step_ = step; }
+            void set_visual_min_temperature(float value) { visual_min_temperature_ = value; }
+            void set_visual_max_temperature(float value) { visual_max_temperature_ = value; }
+            float get_visual_temperature_step() const { return visual_temperature_step_; }
+            float get_visual_min_temperature() const { return visual_min_temperature_; }
+            float get_visual_max_temperature() const { return visual_max_temperature_; }
+
+            void set_supported_modes(std::set<ClimateMode> modes) { supported_modes_ = std::move(modes); }
+            void set_supported_fan_modes(std::set<ClimateFanMode> modes) { supported_fan_modes_ = std::move(modes); }
+            void add_supported_preset(ClimatePreset preset) { supported_presets_.insert(preset); }
+            void add_supported_swing_mode(ClimateSwingMode mode) { supported_swing_modes_.insert(mode); }
+
+            template <typename T>
+            void set_supported_custom_fan_modes(const T &modes) { supported_custom_fan_modes_.assign(std::begin(modes), std::end(modes)); }
+            template <typename T>
+            void set_supported_custom_presets(const T &presets) { supported_custom_presets_.assign(std::begin(presets), std::end(presets)); }
+
+            const std::set<ClimateMode> &get_supported_modes() const { return supported_modes_; }
+            const std::set<ClimateFanMode> &get_supported_fan_modes() const { return supported_fan_modes_; }
+            const std::set<ClimatePreset> &get_supported_presets() const { return supported_presets_; }
+            const std::set<ClimateSwingMode> &get_supported_swing_modes() const { return supported_swing_modes_; }
+            const std::vector<const char *> &get_supported_custom_fan_modes() const { return supported_custom_fan_modes_; }
+            const std::vector<const char *> &get_supported_custom_presets() const { return supported_custom_presets_; }
+
+        protected:
+            uint32_t feature_flags_{0};
+            float visual_temperature_step_{0.1f};
+            float visual_min_temperature_{10};
+            float visual_max_temperature_{30};
+            std::set<ClimateMode> supported_modes_;
+            std::set<ClimateFanMode> supported_fan_modes_;
+            std::set<ClimatePreset> supported_presets_;
+            std::set<ClimateSwingMode> supported_swing_modes_;
+            std::vector<const char *> supported_custom_fan_modes_;
+            std::vector<const char *> supported_custom_presets_;
+        };
+
+        class Climate;
+
+        class ClimateCall
+        {
+        public:
+            explicit ClimateCall(Climate *parent) : parent_(parent) {}
+
+            ClimateCall &set_mode(ClimateMode mode)
+            {
+                mode_ = mode;
+                return *this;
+            }
+            ClimateCall &set_target_temperature(float target_temperature)
+            {
+                target_temperature_ = target_temperature;
+                return *this;
+            }
+            ClimateCall &set_fan_mode(ClimateFanMode fan_mode)
+            {
+                fan_mode_ = fan_mode;
+                custom_fan_mode_.clear();
+                return *this;
+            }
+            ClimateCall &set_fan_mode(const std::string &custom_fan_mode)
+            {
+                fan_mode_.reset();
+                custom_fan_mode_ = custom_fan_mode;
+                return *this;
+            }
+            ClimateCall &set_swing_mode(ClimateSwingMode swing_mode)
+            {
+                swing_mode_ = swing_mode;
+                return *this;
+            }
+            ClimateCall &set_preset(ClimatePreset preset)
+            {
+                preset_ = preset;
+                custom_preset_.clear();
+                return *this;
+            }
+            ClimateCall &set_preset(const std::string &custom_preset)
+            {
+                preset_.reset();
+                custom_preset_ = custom_preset;
+                return *this;
+            }
+
+            const optional<ClimateMode> &get_mode() const { return mode_; }
+            const optional<float> &get_target_temperature() const { return target_temperature_; }
+            const optional<ClimateFanMode> &get_fan_mode() const { return fan_mode_; }
+            const char *get_custom_fan_mode() const { return custom_fan_mode_.c_str(); }
+            const optional<ClimateSwingMode> &get_swing_mode() const { return swing_mode_; }
+            const optional<ClimatePreset> &get_preset() const { return preset_; }
+            const char *get_custom_preset() const { return custom_preset_.c_str(); }
+
+            void perform();
+
+        protected:
+            Climate *parent_;
+            optional<ClimateMode> mode_;
+            optional<float> target_temperature_;
+            optional<ClimateFanMode> fan_mode_;
+            std::string custom_fan_mode_;
+            optional<ClimateSwingMode> swing_mode_;
+            optional<ClimatePreset> preset_;
+            std::string custom_preset_;
+        };
+
+        class Climate : public EntityBase
+        {
+        public:
+            ClimateCall make_call() { return ClimateCall(this); }
+
+            // publishes the whole state as one line, e.g. "mode=COOL target=22 current=24.5 fan=AUTO"
+            void publish_state()
+            {
+                std::string state = "mode=";
+                state += climate_mode_to_string(mode);
+                state += " target=" + format_state(target_temperature);
+                state += " current=" + format_state(current_temperature);
+                if (fan_mode.has_value())
+                    state += std::string(" fan=") + climate_fan_mode_to_string(*fan_mode);
+                else if (!custom_fan_mode_.empty())
+                    state += " fan=" + custom_fan_mode_;
+                state += std::string(" swing=") + climate_swing_mode_to_string(swing_mode);
+                if (preset.has_value())
+                    state += std::string(" preset=") + climate_preset_to_string(*preset);
+                else if (!custom_preset_.empty())
+                    state += " preset=" + custom_preset_;
+                publish_host_state(state);
+            }
+
+            ClimateMode mode{CLIMATE_MODE_OFF};
+            float current_temperature{NAN};
+            float target_temperature{NAN};
+            optional<ClimateFanMode> fan_mode;
+            ClimateSwingMode swing_mode{CLIMATE_SWING_OFF};
+            optional<ClimatePreset> preset;
+
+        protected:
+            friend class ClimateCall;
+
+            virtual void control(const ClimateCall &call) = 0;
+            virtual ClimateTraits traits() = 0;
+
+            void set_fan_mode_(ClimateFanMode mode) { fan_mode = mode; }
+            void set_custom_fan_mode_(const char *mode)
+            {
+                fan_mode.reset();
+                custom_fan_mode_ = mode;
+            }
+            void clear_custom_fan_mode_() { custom_fan_mode_.clear(); }
+
+            void set_preset_(ClimatePreset value) { preset = value; }
+            void set_custom_preset_(const char *value)
+            {
+                preset.reset();
+                custom_preset_ = value;
+            }
+            void clear_custom_preset_() { custom_preset_.clear(); }
+
+            std::string custom_fan_mode_;
+            std::string custom_preset_;
+        };
+
+        inline void ClimateCall::perform()
+        {
+            parent_->control(*this);
+        }
+    } // namespace climate
+} // namespace esphome
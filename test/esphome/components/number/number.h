@@ -0,0 +1,55 @@
+#pragma once
+// Fake Number for Local Testing
+
+#include <cmath>
+#include "esphome/core/entity_base.h"
+
+namespace esphome
+{
+    namespace number
+    {
+        class Number;
+
+        class NumberCall
+        {
+        public:
+            explicit NumberCall(Number *parent) : parent_(parent) {}
+
+            NumberCall &set_value(float value)
+            {
+                value_ = value;
+                return *this;
+            }
+
+            void perform();
+
+        protected:
+            Number *parent_;
+            float value_{NAN};
+        };
+
+        class Number : public EntityBase
+        {
+        public:
+            void publish_state(float state)
+            {
+                this->state = state;
+                publish_host_state(format_state(state));
+            }
+
+            NumberCall make_call() { return NumberCall(this); }
+
+            float state{NAN};
+
+        protected:
+            friend class NumberCall;
+            virtual void control(float value) = 0;
+        };
+
+        inline void NumberCall::perform()
+        {
+            if (!std::isnan(value_))
+                parent_->control(value_);
+        }
+    } // namespace number
+} // namespace esphome
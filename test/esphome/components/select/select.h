@@ -0,0 +1,54 @@
+#pragma once
+// Fake Select for Local Testing
+
+#include <string>
+#include "esphome/core/entity_base.h"
+
+namespace esphome
+{
+    namespace select
+    {
+        class Select;
+
+        class SelectCall
+        {
+        public:
+            explicit SelectCall(Select *parent) : parent_(parent) {}
+
+            SelectCall &set_option(const std::string &option)
+            {
+                option_ = option;
+                return *this;
+            }
+
+            void perform();
+
+        protected:
+            Select *parent_;
+            std::string option_;
+        };
+
+        class Select : public EntityBase
+        {
+        public:
+            void publish_state(const std::string &state)
+            {
+                this->state = state;
+                publish_host_state(state);
+            }
+
+            SelectCall make_call() { return SelectCall(this); }
+
+            std::string state;
+
+        protected:
+            friend class SelectCall;
+            virtual void control(const std::string &value) = 0;
+        };
+
+        inline void SelectCall::perform()
+        {
+            parent_->control(option_);
+        }
+    } // namespace select
+} // namespace esphome
@@ -0,0 +1,23 @@
+#pragma once
+// Fake Sensor for Local Testing
+
+#include <cmath>
+#include "esphome/core/entity_base.h"
+
+namespace esphome
+{
+    namespace sensor
+    {
+        class Sensor : public EntityBase
+        {
+        public:
+            void publish_state(float state)
+            {
+                this->state = state;
+                publish_host_state(format_state(state));
+            }
+
+            float state{NAN};
+        };
+    } // namespace sensor
+} // namespace esphome
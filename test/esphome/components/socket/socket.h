@@ -0,0 +1,85 @@
+#pragma once
+// Fake Socket for Local Testing, plain BSD sockets of the host
+
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace esphome
+{
+    namespace socket
+    {
+        class Socket
+        {
+        public:
+            explicit Socket(int fd) : fd_(fd) {}
+            ~Socket() { ::close(fd_); }
+            Socket(const Socket &) = delete;
+            Socket &operator=(const Socket &) = delete;
+
+            std::unique_ptr<Socket> accept(struct sockaddr *addr, socklen_t *addrlen)
+            {
+                int fd = ::accept(fd_, addr, addrlen);
+                if (fd < 0)
+                    return nullptr;
+                return std::unique_ptr<Socket>(new Socket(fd));
+            }
+
+            int bind(const struct sockaddr *addr, socklen_t addrlen) { return ::bind(fd_, addr, addrlen); }
+            int listen(int backlog) { return ::listen(fd_, backlog); }
+            int setsockopt(int level, int optname, const void *optval, socklen_t optlen) { return ::setsockopt(fd_, level, optname, optval, optlen); }
+            ssize_t read(void *buf, size_t len) { return ::read(fd_, buf, len); }
+            ssize_t write(const void *buf, size_t len) { return ::send(fd_, buf, len, MSG_NOSIGNAL); }
+            int get_fd() const { return fd_; }
+
+            int setblocking(bool blocking)
+            {
+                int flags = fcntl(fd_, F_GETFL, 0);
+                return fcntl(fd_, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK);
+            }
+
+        protected:
+            int fd_;
+        };
+
+        inline std::unique_ptr<Socket> socket_ip(int type, int protocol)
+        {
+            int fd = ::socket(AF_INET6, type, protocol);
+            if (fd < 0)
+                fd = ::socket(AF_INET, type, protocol);
+            if (fd < 0)
+                return nullptr;
+            return std::unique_ptr<Socket>(new Socket(fd));
+        }
+
+        // any address of the family socket_ip uses
+        inline socklen_t set_sockaddr_any(struct sockaddr *addr, socklen_t addrlen, uint16_t port)
+        {
+            int probe = ::socket(AF_INET6, SOCK_STREAM, 0);
+            const bool ipv6 = probe >= 0;
+            if (probe >= 0)
+                ::close(probe);
+
+            if (ipv6 && addrlen >= sizeof(sockaddr_in6))
+            {
+                auto *server = reinterpret_cast<sockaddr_in6 *>(addr);
+                memset(server, 0, sizeof(sockaddr_in6));
+                server->sin6_family = AF_INET6;
+                server->sin6_port = htons(port);
+                server->sin6_addr = in6addr_any;
+                return sizeof(sockaddr_in6);
+            }
+            if (addrlen < sizeof(sockaddr_in))
+                return 0;
+            auto *server = reinterpret_cast<sockaddr_in *>(addr);
+            memset(server, 0, sizeof(sockaddr_in));
+            server->sin_family = AF_INET;
+            server->sin_port = htons(port);
+            server->sin_addr.s_addr = INADDR_ANY;
+            return sizeof(sockaddr_in);
+        }
+    } // namespace socket
+} // namespace esphome
@@ -0,0 +1,29 @@
+#pragma once
+// Fake Switch for Local Testing
+
+#include "esphome/core/entity_base.h"
+
+namespace esphome
+{
+    namespace switch_
+    {
+        class Switch : public EntityBase
+        {
+        public:
+            void publish_state(bool state)
+            {
+                this->state = state;
+                publish_host_state(state ? "ON" : "OFF");
+            }
+
+            void turn_on() { write_state(true); }
+            void turn_off() { write_state(false); }
+            void toggle() { write_state(!state); }
+
+            bool state{false};
+
+        protected:
+            virtual void write_state(bool state) = 0;
+        };
+    } // namespace switch_
+} // namespace esphome
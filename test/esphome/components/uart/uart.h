@@ -0,0 +1,207 @@
+#pragma once
+// Fake UART for Local Testing, HostUARTComponent talks to a serial port through termios
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace uart
+    {
+        enum UARTParityOptions
+        {
+            UART_CONFIG_PARITY_NONE,
+            UART_CONFIG_PARITY_EVEN,
+            UART_CONFIG_PARITY_ODD,
+        };
+
+        class UARTComponent
+        {
+        public:
+            virtual ~UARTComponent() = default;
+            virtual void write_array(const uint8_t *data, size_t len) = 0;
+            virtual bool peek_byte(uint8_t *data) = 0;
+            virtual bool read_array(uint8_t *data, size_t len) = 0;
+            virtual int available() = 0;
+            virtual void flush() = 0;
+        };
+
+        class UARTDevice
+        {
+        public:
+            UARTDevice() = default;
+            UARTDevice(UARTComponent *parent) : parent_(parent) {}
+
+            void set_uart_parent(UARTComponent *parent) { parent_ = parent; }
+
+            void write_array(const std::vector<uint8_t> &data) { parent_->write_array(data.data(), data.size()); }
+            void write_array(const uint8_t *data, size_t len) { parent_->write_array(data, len); }
+            bool read_byte(uint8_t *data) { return parent_->read_array(data, 1); }
+            bool read_array(uint8_t *data, size_t len) { return parent_->read_array(data, len); }
+            bool peek_byte(uint8_t *data) { return parent_->peek_byte(data); }
+            int available() { return parent_->available(); }
+            void flush() { parent_->flush(); }
+
+        protected:
+            UARTComponent *parent_{nullptr};
+        };
+
+        // serial port of the host, raw 8 data bits with the given parity and one stop bit
+        class HostUARTComponent : public UARTComponent
+        {
+        public:
+            ~HostUARTComponent() override { close(); }
+
+            bool open(const std::string &path, uint32_t baud_rate, UARTParityOptions parity = UART_CONFIG_PARITY_EVEN)
+            {
+                close();
+                fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+                if (fd_ < 0)
+                {
+                    ESP_LOGE("uart", "Could not open %s: %s", path.c_str(), strerror(errno));
+                    return false;
+                }
+
+                termios tio;
+                if (tcgetattr(fd_, &tio) == 0)
+                {
+                    cfmakeraw(&tio);
+                    tio.c_cflag |= CLOCAL | CREAD;
+                    tio.c_cflag &= ~(CSTOPB | PARENB | PARODD);
+                    if (parity != UART_CONFIG_PARITY_NONE)
+                        tio.c_cflag |= PARENB;
+                    if (parity == UART_CONFIG_PARITY_ODD)
+                        tio.c_cflag |= PARODD;
+                    tio.c_cc[VMIN] = 0;
+                    tio.c_cc[VTIME] = 0;
+                    speed_t speed = to_speed(baud_rate);
+                    cfsetispeed(&tio, speed);
+                    cfsetospeed(&tio, speed);
+                    // pseudo-terminals of the bus simulator do not support every setting
+                    if (tcsetattr(fd_, TCSANOW, &tio) != 0)
+                        ESP_LOGW("uart", "Could not configure %s: %s", path.c_str(), strerror(errno));
+                }
+                return true;
+            }
+
+            void close()
+            {
+                if (fd_ >= 0)
+                    ::close(fd_);
+                fd_ = -1;
+                rx_.clear();
+            }
+
+            int get_fd() const { return fd_; }
+
+            // reads everything the kernel buffered, returns false when the port is gone
+            bool fill()
+            {
+                uint8_t buffer[512];
+                while (true)
+                {
+                    ssize_t size = ::read(fd_, buffer, sizeof(buffer));
+                    if (size > 0)
+                    {
+                        rx_.insert(rx_.end(), buffer, buffer + size);
+                        continue;
+                    }
+                    // a tty without data returns 0 because of VMIN 0, a hangup tells it apart from an unplugged port
+                    if (size == 0)
+                    {
+                        pollfd hangup{fd_, POLLIN, 0};
+                        return poll(&hangup, 1, 0) <= 0 || (hangup.revents & POLLHUP) == 0;
+                    }
+                    return errno == EAGAIN || errno == EINTR;
+                }
+            }
+
+            void write_array(const uint8_t *data, size_t len) override
+            {
+                while (len > 0 && fd_ >= 0)
+                {
+                    ssize_t written = ::write(fd_, data, len);
+                    if (written < 0)
+                    {
+                        if (errno == EAGAIN || errno == EINTR)
+                            continue;
+                        ESP_LOGE("uart", "Write failed: %s", strerror(errno));
+                        return;
+                    }
+                    data += written;
+                    len -= written;
+                }
+            }
+
+            bool peek_byte(uint8_t *data) override
+            {
+                if (rx_.empty())
+                    fill();
+                if (rx_.empty())
+                    return false;
+                *data = rx_.front();
+                return true;
+            }
+
+            bool read_array(uint8_t *data, size_t len) override
+            {
+                if (rx_.size() < len)
+                    fill();
+                if (rx_.size() < len)
+                    return false;
+                std::copy(rx_.begin(), rx_.begin() + len, data);
+                rx_.erase(rx_.begin(), rx_.begin() + len);
+                return true;
+            }
+
+            int available() override
+            {
+                if (rx_.empty() && fd_ >= 0)
+                    fill();
+                return rx_.size();
+            }
+
+            void flush() override
+            {
+                if (fd_ >= 0)
+                    tcdrain(fd_);
+            }
+
+        protected:
+            static speed_t to_speed(uint32_t baud_rate)
+            {
+                switch (baud_rate)
+                {
+                case 1200:
+                    return B1200;
+                case 2400:
+                    return B2400;
+                case 4800:
+                    return B4800;
+                case 19200:
+                    return B19200;
+                case 38400:
+                    return B38400;
+                case 57600:
+                    return B57600;
+                case 115200:
+                    return B115200;
+                default:
+                    return B9600;
+                }
+            }
+
+            int fd_{-1};
+            std::deque<uint8_t> rx_;
+        };
+    } // namespace uart
+} // namespace esphome
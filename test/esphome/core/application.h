@@ -0,0 +1,43 @@
+#pragma once
+// Fake Application for Local Testing, runs the registered components like the esphome main loop
+
+#include <algorithm>
+#include <vector>
+#include "component.h"
+
+namespace esphome
+{
+    class Application
+    {
+    public:
+        void register_component(Component *component)
+        {
+            components_.push_back(component);
+        }
+
+        void setup()
+        {
+            std::stable_sort(components_.begin(), components_.end(), [](Component *a, Component *b)
+                             { return a->get_setup_priority() > b->get_setup_priority(); });
+            for (Component *component : components_)
+            {
+                component->call_setup();
+                component->dump_config();
+            }
+        }
+
+        void loop()
+        {
+            for (Component *component : components_)
+            {
+                if (!component->is_failed())
+                    component->call_loop();
+            }
+        }
+
+    protected:
+        std::vector<Component *> components_;
+    };
+
+    extern Application App;
+} // namespace esphome
@@ -0,0 +1,130 @@
+#pragma once
+// Fake Component for Local Testing, the scheduler is run by the Application
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "hal.h"
+#include "gpio.h"
+#include "helpers.h"
+#include "optional.h"
+
+namespace esphome
+{
+    namespace setup_priority
+    {
+        const float BUS = 1000.0f;
+        const float IO = 900.0f;
+        const float HARDWARE = 800.0f;
+        const float DATA = 600.0f;
+        const float PROCESSOR = 400.0f;
+        const float WIFI = 250.0f;
+        const float AFTER_WIFI = 200.0f;
+        const float AFTER_CONNECTION = 100.0f;
+        const float LATE = -100.0f;
+    } // namespace setup_priority
+
+    class Component
+    {
+    public:
+        virtual ~Component() = default;
+
+        virtual void setup() {}
+        virtual void loop() {}
+        virtual void dump_config() {}
+        virtual float get_setup_priority() const { return setup_priority::DATA; }
+
+        virtual void call_setup()
+        {
+            setup();
+        }
+
+        // runs the due intervals and timeouts, then the loop
+        void call_loop()
+        {
+            run_scheduler(millis());
+            loop();
+        }
+
+        void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f)
+        {
+            cancel(name);
+            scheduled_.push_back(Scheduled{name, interval, millis(), true, std::move(f)});
+        }
+
+        void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f)
+        {
+            cancel(name);
+            scheduled_.push_back(Scheduled{name, timeout, millis(), false, std::move(f)});
+        }
+
+        bool cancel_interval(const std::string &name) { return cancel(name); }
+        bool cancel_timeout(const std::string &name) { return cancel(name); }
+
+        void mark_failed() { failed_ = true; }
+        bool is_failed() const { return failed_; }
+
+    protected:
+        struct Scheduled
+        {
+            std::string name;
+            uint32_t interval;
+            uint32_t last;
+            bool repeat;
+            std::function<void()> f;
+        };
+
+        bool cancel(const std::string &name)
+        {
+            for (auto it = scheduled_.begin(); it != scheduled_.end(); ++it)
+            {
+                if (it->name == name)
+                {
+                    scheduled_.erase(it);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void run_scheduler(uint32_t now)
+        {
+            for (size_t i = 0; i < scheduled_.size(); i++)
+            {
+                if (now - scheduled_[i].last < scheduled_[i].interval)
+                    continue;
+                scheduled_[i].last = now;
+                auto f = scheduled_[i].f;
+                if (!scheduled_[i].repeat)
+                    scheduled_.erase(scheduled_.begin() + i--);
+                f();
+            }
+        }
+
+        std::vector<Scheduled> scheduled_;
+        bool failed_{false};
+    };
+
+    class PollingComponent : public Component
+    {
+    public:
+        PollingComponent() : PollingComponent(0) {}
+        PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+
+        virtual void update() = 0;
+
+        void call_setup() override
+        {
+            setup();
+            if (update_interval_ > 0)
+                set_interval("update", update_interval_, [this]()
+                             { update(); });
+        }
+
+        void set_update_interval(uint32_t update_interval) { update_interval_ = update_interval; }
+        uint32_t get_update_interval() const { return update_interval_; }
+
+    protected:
+        uint32_t update_interval_;
+    };
+} // namespace esphome
@@ -0,0 +1,41 @@
+#pragma once
+// Fake EntityBase for Local Testing, published states are passed to a hook of the host application
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include "helpers.h"
+
+namespace esphome
+{
+    class EntityBase
+    {
+    public:
+        virtual ~EntityBase() = default;
+
+        const std::string &get_name() const { return name_; }
+        void set_name(const std::string &name) { name_ = name; }
+
+        // called with the state of every entity which publishes, e.g. to print it
+        inline static std::function<void(const EntityBase *entity, const std::string &state)> on_publish;
+
+    protected:
+        void publish_host_state(const std::string &state)
+        {
+            if (on_publish)
+                on_publish(this, state);
+        }
+
+        static std::string format_state(float value)
+        {
+            if (std::isnan(value))
+                return "unknown";
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%g", value);
+            return buffer;
+        }
+
+        std::string name_;
+    };
+} // namespace esphome
@@ -0,0 +1,23 @@
+#pragma once
+// Fake GPIO for Local Testing
+
+#include <string>
+#include "log.h"
+
+namespace esphome
+{
+    class GPIOPin
+    {
+    public:
+        virtual void setup() = 0;
+        virtual bool digital_read() = 0;
+        virtual void digital_write(bool value) = 0;
+        virtual std::string dump_summary() const = 0;
+    };
+
+#define LOG_PIN(prefix, pin)                                          \
+    if ((pin) != nullptr)                                             \
+    {                                                                 \
+        ESP_LOGCONFIG(TAG, prefix "%s", (pin)->dump_summary().c_str()); \
+    }
+} // namespace esphome
@@ -0,0 +1,39 @@
+#pragma once
+// Fake helpers for Local Testing
+
+#include <cstdint>
+#include <string>
+#include <strings.h>
+
+namespace esphome
+{
+    inline uint32_t fnv1_hash(const std::string &str)
+    {
+        uint32_t hash = 2166136261UL;
+        for (char c : str)
+        {
+            hash *= 16777619UL;
+            hash ^= (uint8_t)c;
+        }
+        return hash;
+    }
+
+    inline bool str_equals_case_insensitive(const std::string &a, const std::string &b)
+    {
+        return strcasecmp(a.c_str(), b.c_str()) == 0;
+    }
+
+    template <typename T>
+    class Parented
+    {
+    public:
+        Parented() {}
+        Parented(T *parent) : parent_(parent) {}
+
+        T *get_parent() const { return parent_; }
+        void set_parent(T *parent) { parent_ = parent; }
+
+    protected:
+        T *parent_{nullptr};
+    };
+} // namespace esphome
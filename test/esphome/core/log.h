@@ -1,24 +1,42 @@
 #pragma once
 // Fake Log for Local Testing
 
+#include <cstdio>
+#include <string>
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+
 namespace esphome
 {
+    // messages above this level are not printed, e.g. lowered by the gateway
+    inline int log_level = ESPHOME_LOG_LEVEL_VERBOSE;
 
-#define ESP_LOG(level, TAG, format, ...)      \
-    do                                        \
-    {                                         \
-        std::string str = "[";                \
-        str += level;                         \
-        str += "] ";                          \
-        str += format;                        \
-        str += "\n";                          \
-        printf((str.c_str()), ##__VA_ARGS__); \
+#define ESP_LOG_AT(severity, level, TAG, format, ...) \
+    do                                                \
+    {                                                 \
+        if ((severity) > esphome::log_level)          \
+            break;                                    \
+        std::string str = "[";                        \
+        str += level;                                 \
+        str += "] ";                                  \
+        str += format;                                \
+        str += "\n";                                  \
+        printf((str.c_str()), ##__VA_ARGS__);         \
     } while (0);
 
-#define ESP_LOGD(TAG, format, ...) ESP_LOG("DEBUG", TAG, format, ##__VA_ARGS__)
-#define ESP_LOGE(TAG, format, ...) ESP_LOG("ERROR", TAG, format, ##__VA_ARGS__)
-#define ESP_LOGW(TAG, format, ...) ESP_LOG("WARN", TAG, format, ##__VA_ARGS__)
-#define ESP_LOGV(TAG, format, ...) ESP_LOG("VERBOSE", TAG, format, ##__VA_ARGS__)
-#define ESP_LOGI(TAG, format, ...) ESP_LOG("INFO", TAG, format, ##__VA_ARGS__)
+#define ESP_LOG(level, TAG, format, ...) ESP_LOG_AT(ESPHOME_LOG_LEVEL_NONE, level, TAG, format, ##__VA_ARGS__)
+
+#define ESP_LOGD(TAG, format, ...) ESP_LOG_AT(ESPHOME_LOG_LEVEL_DEBUG, "DEBUG", TAG, format, ##__VA_ARGS__)
+#define ESP_LOGE(TAG, format, ...) ESP_LOG_AT(ESPHOME_LOG_LEVEL_ERROR, "ERROR", TAG, format, ##__VA_ARGS__)
+#define ESP_LOGW(TAG, format, ...) ESP_LOG_AT(ESPHOME_LOG_LEVEL_WARN, "WARN", TAG, format, ##__VA_ARGS__)
+#define ESP_LOGV(TAG, format, ...) ESP_LOG_AT(ESPHOME_LOG_LEVEL_VERBOSE, "VERBOSE", TAG, format, ##__VA_ARGS__)
+#define ESP_LOGI(TAG, format, ...) ESP_LOG_AT(ESPHOME_LOG_LEVEL_INFO, "INFO", TAG, format, ##__VA_ARGS__)
+#define ESP_LOGCONFIG(TAG, format, ...) ESP_LOG_AT(ESPHOME_LOG_LEVEL_CONFIG, "CONFIG", TAG, format, ##__VA_ARGS__)
 
 } // namespace esphome
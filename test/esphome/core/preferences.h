@@ -0,0 +1,63 @@
+#pragma once
+// Fake Preferences for Local Testing, backed by whatever ESPPreferences implementation is installed
+
+#include <cstdint>
+#include <cstddef>
+
+namespace esphome
+{
+    class ESPPreferenceBackend
+    {
+    public:
+        virtual ~ESPPreferenceBackend() = default;
+        virtual bool save(const uint8_t *data, size_t len) = 0;
+        virtual bool load(uint8_t *data, size_t len) = 0;
+    };
+
+    class ESPPreferenceObject
+    {
+    public:
+        ESPPreferenceObject() = default;
+        ESPPreferenceObject(ESPPreferenceBackend *backend) : backend_(backend) {}
+
+        template <typename T>
+        bool save(const T *src)
+        {
+            if (backend_ == nullptr)
+                return false;
+            return backend_->save(reinterpret_cast<const uint8_t *>(src), sizeof(T));
+        }
+
+        template <typename T>
+        bool load(T *dest)
+        {
+            if (backend_ == nullptr)
+                return false;
+            return backend_->load(reinterpret_cast<uint8_t *>(dest), sizeof(T));
+        }
+
+    protected:
+        ESPPreferenceBackend *backend_{nullptr};
+    };
+
+    class ESPPreferences
+    {
+    public:
+        virtual ~ESPPreferences() = default;
+        virtual ESPPreferenceObject make_preference(size_t length, uint32_t type, bool in_flash) = 0;
+
+        template <typename T>
+        ESPPreferenceObject make_preference(uint32_t type, bool in_flash)
+        {
+            return make_preference(sizeof(T), type, in_flash);
+        }
+
+        template <typename T>
+        ESPPreferenceObject make_preference(uint32_t type)
+        {
+            return make_preference(sizeof(T), type, false);
+        }
+    };
+
+    extern ESPPreferences *global_preferences;
+} // namespace esphome
@@ -0,0 +1,2 @@
+g++ -O2 test/main_export_series.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp -Itest -pthread -o export_series
+./export_series "$@"
\ No newline at end of file
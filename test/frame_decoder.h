@@ -0,0 +1,134 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <string>
+#include "capture_file.h"
+#include "frame_splitter.h"
+#include "work_stealing_pool.h"
+#include "../components/samsung_ac/device_registry.h"
+#include "../components/samsung_ac/protocol_nasa.h"
+#include "../components/samsung_ac/protocol_non_nasa.h"
+
+using namespace esphome::samsung_ac;
+
+// One decoded value. NASA frames give one row per message with a numeric value, NonNASA frames
+// one row per frame with the command as message and the decoded fields as text.
+struct DecodedRow
+{
+    uint32_t time;
+    PackedAddress source;
+    uint16_t message;
+    int64_t value;
+    std::string text;
+};
+
+inline PackedAddress pack_address(const Address &address)
+{
+    return (uint32_t)address.klass << 16 | (uint32_t)address.channel << 8 | address.address;
+}
+
+// decodes a frame found by split_frames with the component's own decoders, returns false if
+// the decoder rejected it
+inline bool decode_frame(const FrameRef &frame, std::vector<DecodedRow> &rows)
+{
+    std::vector<uint8_t> data(frame.data, frame.data + frame.length);
+
+    if (frame.length == 14)
+    {
+        NonNasaDataPacket packet;
+        if (packet.decode(data).type != DecodeResultType::Processed)
+            return false;
+        rows.push_back(DecodedRow{frame.time, pack_address(packet.src), (uint16_t)packet.cmd, 0, packet.to_string()});
+        return true;
+    }
+
+    Packet packet;
+    if (packet.decode(data).type != DecodeResultType::Processed)
+        return false;
+
+    PackedAddress source = pack_address(packet.sa);
+    for (const auto &message : packet.messages)
+    {
+        // structures have no single value
+        if (message.type == Structure)
+            continue;
+        rows.push_back(DecodedRow{frame.time, source, (uint16_t)message.messageNumber, message.value, std::string()});
+    }
+    return true;
+}
+
+// All frames of a capture file or a raw bus dump. Frames of a capture keep their time, a raw
+// dump is split at frame boundaries and uses the position of the frame as time.
+class FrameSource
+{
+public:
+    bool open(const std::string &path)
+    {
+        frames.clear();
+        skipped = 0;
+        if (capture_.open(path))
+        {
+            capture_.for_each([this](uint64_t, const CaptureRecord &record)
+                              {
+                if (record.direction == CaptureDirection::Received || record.direction == CaptureDirection::Sent)
+                    skipped += split_frames(record.data, record.length, record.time, frames);
+                return true; });
+            return true;
+        }
+
+        if (!raw_.open(path))
+            return false;
+        skipped = split_frames(raw_.data(), raw_.size(), 0, frames);
+        for (size_t i = 0; i < frames.size(); i++)
+            frames[i].time = i;
+        return true;
+    }
+
+    std::vector<FrameRef> frames;
+    size_t skipped = 0; // bytes outside of frames
+
+protected:
+    CaptureFile capture_;
+    MappedFile raw_;
+};
+
+// frames decoded by one task, small enough to keep all cores busy until the end
+const size_t framesPerChunk = 16384;
+
+// Decodes chunks of frames in parallel and calls output(rows) in frame order: whoever completes
+// the next chunk in order hands it over, together with all directly following ones which are
+// already done. Returns the number of frames rejected by the decoder.
+template <typename F>
+size_t decode_frames(const std::vector<FrameRef> &frames, WorkStealingPool &pool, F output)
+{
+    const size_t chunks = (frames.size() + framesPerChunk - 1) / framesPerChunk;
+    std::vector<std::vector<DecodedRow>> results(chunks);
+    std::vector<bool> done(chunks);
+    size_t next = 0;
+    size_t invalid = 0;
+    std::mutex mutex;
+
+    pool.run(chunks, [&](size_t chunk)
+             {
+        std::vector<DecodedRow> decoded;
+        size_t rejected = 0;
+        size_t end = std::min(frames.size(), (chunk + 1) * framesPerChunk);
+        for (size_t i = chunk * framesPerChunk; i < end; i++)
+        {
+            if (!decode_frame(frames[i], decoded))
+                rejected++;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        invalid += rejected;
+        results[chunk] = std::move(decoded);
+        done[chunk] = true;
+        while (next < chunks && done[next])
+        {
+            output(results[next]);
+            std::vector<DecodedRow>().swap(results[next]);
+            next++;
+        } });
+    return invalid;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../components/samsung_ac/frame.h"
+
+// A frame inside a capture, data points into the (mapped) file.
+struct FrameRef
+{
+    uint32_t time;
+    const uint8_t *data;
+    uint16_t length;
+};
+
+using esphome::samsung_ac::frame_crc16;
+using esphome::samsung_ac::frame_length;
+using esphome::samsung_ac::next_frame_start;
+
+// length of the NASA or NonNASA frame starting at data, 0 if there is no complete frame with
+// valid length, end byte and crc/checksum
+inline size_t valid_frame_length(const uint8_t *data, size_t size)
+{
+    int length = frame_length(data, size);
+    return length > 0 ? length : 0;
+}
+
+// appends all valid frames of a raw byte stream, returns the number of bytes which did not
+// belong to a frame (line noise, collisions, cut off frames)
+inline size_t split_frames(const uint8_t *data, size_t size, uint32_t time, std::vector<FrameRef> &frames)
+{
+    size_t skipped = 0;
+    size_t offset = 0;
+    while (offset < size)
+    {
+        int length = frame_length(data + offset, size - offset);
+        // nothing follows the data, so a frame which is still incomplete was cut off
+        if (length == 0)
+            length = -(int)next_frame_start(data + offset, size - offset, 1);
+        if (length < 0)
+        {
+            skipped += -length;
+            offset += -length;
+            continue;
+        }
+
+        frames.push_back(FrameRef{time, data + offset, (uint16_t)length});
+        offset += length;
+    }
+    return skipped;
+}
@@ -0,0 +1,3 @@
+# -g and frame pointers for perf record -g
+g++ -O2 -g -fno-omit-frame-pointer test/main_gateway.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp components/samsung_ac/conversions.cpp components/samsung_ac/samsung_ac.cpp components/samsung_ac/samsung_ac_device.cpp components/samsung_ac/raw_stream.cpp components/samsung_ac/rx_task.cpp -Itest -pthread -o gateway
+./gateway "$@"
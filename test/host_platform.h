@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include "esphome/core/hal.h"
+#include "esphome/core/application.h"
+#include "esphome/core/preferences.h"
+
+// Platform layer to run the component natively on Linux: the hal on a monotonic clock, the
+// preferences in a file and the Application which runs the main loop.
+// This header must be included by exactly one translation unit of a program, it can not be
+// combined with virtual_clock.h.
+
+namespace esphome
+{
+    static const auto host_start = std::chrono::steady_clock::now();
+
+    uint32_t millis()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - host_start).count();
+    }
+
+    uint32_t micros()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - host_start).count();
+    }
+
+    void delay(uint32_t ms)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+
+    Application App;
+
+    // all preferences of a program in one file of (type u32, length u32, data) records, which is
+    // rewritten on every save. Saves are rare, the component only writes when a value changed.
+    class FilePreferences : public ESPPreferences
+    {
+    public:
+        explicit FilePreferences(const std::string &path) : path_(path)
+        {
+            std::ifstream file(path_, std::ios::binary);
+            uint32_t header[2];
+            while (file.read(reinterpret_cast<char *>(header), sizeof(header)))
+            {
+                std::vector<uint8_t> data(header[1]);
+                if (!file.read(reinterpret_cast<char *>(data.data()), data.size()))
+                    break;
+                values_[header[0]] = std::move(data);
+            }
+        }
+
+        using ESPPreferences::make_preference;
+
+        ESPPreferenceObject make_preference(size_t length, uint32_t type, bool in_flash) override
+        {
+            backends_.emplace_back(this, type, length);
+            return ESPPreferenceObject(&backends_.back());
+        }
+
+    protected:
+        class Backend : public ESPPreferenceBackend
+        {
+        public:
+            Backend(FilePreferences *parent, uint32_t type, size_t length) : parent_(parent), type_(type), length_(length) {}
+
+            bool save(const uint8_t *data, size_t len) override
+            {
+                parent_->values_[type_].assign(data, data + len);
+                return parent_->write();
+            }
+
+            bool load(uint8_t *data, size_t len) override
+            {
+                auto it = parent_->values_.find(type_);
+                // a changed struct does not match the stored value anymore
+                if (it == parent_->values_.end() || it->second.size() != len || len != length_)
+                    return false;
+                std::copy(it->second.begin(), it->second.end(), data);
+                return true;
+            }
+
+        protected:
+            FilePreferences *parent_;
+            uint32_t type_;
+            size_t length_;
+        };
+
+        bool write()
+        {
+            const std::string temp = path_ + ".tmp";
+            {
+                std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+                for (const auto &value : values_)
+                {
+                    uint32_t header[2] = {value.first, (uint32_t)value.second.size()};
+                    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+                    file.write(reinterpret_cast<const char *>(value.second.data()), value.second.size());
+                }
+                if (!file)
+                    return false;
+            }
+            return rename(temp.c_str(), path_.c_str()) == 0;
+        }
+
+        std::string path_;
+        std::map<uint32_t, std::vector<uint8_t>> values_;
+        std::deque<Backend> backends_; // stable addresses for the preference objects
+    };
+
+    ESPPreferences *global_preferences = nullptr;
+} // namespace esphome
@@ -0,0 +1,2 @@
+g++ -O2 test/main_load_test.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp -Itest -pthread -o load_test
+./load_test "$@"
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "bus_simulator.h"
+
+using namespace std;
+
+// Offers a simulated bus on a pseudo-terminal in real time, e.g.
+//   bus_simulator --units 8 --crc-errors 0.01
+// prints the path of the terminal, which can be used like the serial port of the adapter.
+int main(int argc, char *argv[])
+{
+    BusSimulatorOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--nonnasa") == 0)
+            options.nasa = false;
+        else if (strcmp(argv[i], "--units") == 0 && i + 1 < argc)
+            options.indoor_units = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--crc-errors") == 0 && i + 1 < argc)
+            options.crc_error_rate = atof(argv[++i]);
+        else if (strcmp(argv[i], "--collisions") == 0 && i + 1 < argc)
+            options.collision_rate = atof(argv[++i]);
+        else
+        {
+            cerr << "usage: " << argv[0] << " [--nonnasa] [--units n] [--crc-errors rate] [--collisions rate]" << endl;
+            return 1;
+        }
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        cerr << "could not open a pseudo-terminal: " << strerror(errno) << endl;
+        return 1;
+    }
+
+    // raw bytes, no echo or line editing
+    termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    cout << ptsname(master) << endl;
+    cerr << (options.nasa ? "NASA" : "NonNASA") << " bus with " << options.indoor_units << " indoor units" << endl;
+
+    VirtualClock &clock = VirtualClock::instance();
+    BusSimulator sim(options, clock);
+    const auto start = chrono::steady_clock::now();
+    vector<uint8_t> bytes;
+    uint8_t buffer[256];
+    uint32_t next_report = 60000;
+
+    while (true)
+    {
+        clock.set(chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count());
+
+        bytes.clear();
+        sim.update(bytes);
+        // nobody listens until the terminal is opened, the bytes are lost like on a real bus
+        if (!bytes.empty() && write(master, bytes.data(), bytes.size()) < 0 && errno != EAGAIN && errno != EIO)
+        {
+            cerr << "write failed: " << strerror(errno) << endl;
+            return 1;
+        }
+
+        ssize_t size;
+        while ((size = read(master, buffer, sizeof(buffer))) > 0)
+            sim.receive(buffer, size);
+
+        if (clock.now() >= next_report)
+        {
+            next_report += 60000;
+            const auto &stats = sim.stats();
+            cerr << clock.now() / 1000 << " s: sent " << stats.frames_sent << " (" << stats.crc_errors << " crc errors, "
+                 << stats.collisions << " collisions), received " << stats.frames_received << ", commands "
+                 << stats.commands_received << " (" << stats.commands_applied << " applied)" << endl;
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+}
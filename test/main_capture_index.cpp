@@ -0,0 +1,86 @@
+#include <iostream>
+#include <algorithm>
+#include "host_platform.h"
+#include "capture_file.h"
+#include "frame_decoder.h"
+
+using namespace std;
+
+// source address and message numbers (NASA) or command (NonNASA) of a frame
+bool get_index_keys(const CaptureRecord &record, uint32_t &source, std::vector<uint16_t> &messages)
+{
+    std::vector<uint8_t> data(record.data, record.data + record.length);
+    messages.clear();
+
+    NonNasaDataPacket non_nasa;
+    if (non_nasa.decode(data).type == DecodeResultType::Processed)
+    {
+        source = pack_address(non_nasa.src);
+        messages.push_back((uint16_t)non_nasa.cmd);
+        return source != invalidPackedAddress;
+    }
+
+    Packet nasa;
+    if (nasa.decode(data).type != DecodeResultType::Processed)
+        return false;
+
+    source = pack_address(nasa.sa);
+    for (const auto &message : nasa.messages)
+        messages.push_back((uint16_t)message.messageNumber);
+    std::sort(messages.begin(), messages.end());
+    messages.erase(std::unique(messages.begin(), messages.end()), messages.end());
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        cerr << "usage: " << argv[0] << " <capture file> <indexed capture file>" << endl;
+        return 1;
+    }
+
+    CaptureFile input;
+    if (!input.open(argv[1]))
+    {
+        cerr << "could not open capture " << argv[1] << endl;
+        return 1;
+    }
+
+    CaptureFileWriter output;
+    if (!output.open(argv[2]))
+    {
+        cerr << "could not create " << argv[2] << endl;
+        return 1;
+    }
+
+    uint64_t frames = 0;
+    uint64_t indexed = 0;
+    uint32_t source;
+    std::vector<uint16_t> messages;
+    input.for_each([&](uint64_t, const CaptureRecord &record)
+                   {
+        uint64_t offset = output.add(record.time, record.direction, record.data, record.length);
+        frames++;
+
+        if (record.direction == CaptureDirection::Dropped || !get_index_keys(record, source, messages))
+            return true;
+
+        indexed++;
+        output.index(source, captureAnyMessage, offset);
+        for (uint16_t message : messages)
+        {
+            if (message != captureAnyMessage)
+                output.index(source, message, offset);
+        }
+        return true; });
+
+    if (!output.close())
+    {
+        cerr << "could not write " << argv[2] << endl;
+        return 1;
+    }
+
+    cout << frames << " records, " << indexed << " indexed" << endl;
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <cstdlib>
+#include "capture_file.h"
+#include "../components/samsung_ac/device_registry.h"
+#include "../components/samsung_ac/util.h"
+
+using namespace std;
+
+const char *direction_to_str(CaptureDirection direction)
+{
+    switch (direction)
+    {
+    case CaptureDirection::Received:
+        return "rx";
+    case CaptureDirection::Sent:
+        return "tx";
+    case CaptureDirection::Discarded:
+        return "discarded";
+    case CaptureDirection::Dropped:
+        return "dropped";
+    default:
+        return "unknown";
+    }
+}
+
+// prints all frames of a source, optionally only those containing a message, e.g.
+// capture_query capture.sacp 20.00.02 4203
+int main(int argc, char *argv[])
+{
+    if (argc != 3 && argc != 4)
+    {
+        cerr << "usage: " << argv[0] << " <indexed capture file> <source> [message (hex)]" << endl;
+        return 1;
+    }
+
+    CaptureFile file;
+    if (!file.open(argv[1]))
+    {
+        cerr << "could not open capture " << argv[1] << endl;
+        return 1;
+    }
+    if (!file.has_index())
+    {
+        cerr << argv[1] << " has no index, create one with capture_index" << endl;
+        return 1;
+    }
+
+    uint32_t source = pack_address(argv[2]);
+    if (source == invalidPackedAddress)
+    {
+        cerr << "invalid address " << argv[2] << endl;
+        return 1;
+    }
+    uint16_t message = argc == 4 ? (uint16_t)strtoul(argv[3], nullptr, 16) : captureAnyMessage;
+
+    auto offsets = file.find(source, message);
+    CaptureRecord record;
+    for (uint64_t offset : offsets)
+    {
+        if (!file.record_at(offset, record))
+            continue;
+        std::vector<uint8_t> data(record.data, record.data + record.length);
+        cout << record.time << " " << direction_to_str(record.direction) << " " << bytes_to_hex(data) << endl;
+    }
+
+    cerr << offsets.size() << " frames" << endl;
+    return 0;
+}
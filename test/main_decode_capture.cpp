@@ -0,0 +1,151 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include "frame_decoder.h"
+
+using namespace std;
+
+// the hal of the protocol code, decoding a capture needs no clock
+namespace esphome
+{
+    uint32_t millis()
+    {
+        return 0;
+    }
+    void delay(uint32_t ms) {}
+} // namespace esphome
+
+class RowOutput
+{
+public:
+    virtual ~RowOutput() = default;
+    virtual void write(const std::vector<DecodedRow> &rows) = 0;
+};
+
+// time,source,message,value - NonNASA rows carry the decoded fields as value
+class CsvOutput : public RowOutput
+{
+public:
+    explicit CsvOutput(std::ostream &out) : out_(out)
+    {
+        out_ << "time,source,message,value\n";
+    }
+
+    void write(const std::vector<DecodedRow> &rows) override
+    {
+        for (const auto &row : rows)
+        {
+            out_ << row.time << ',' << unpack_address(row.source) << ',' << long_to_hex(row.message) << ',';
+            if (row.text.empty())
+                out_ << row.value << '\n';
+            else
+                out_ << '"' << row.text << "\"\n";
+        }
+    }
+
+protected:
+    std::ostream &out_;
+};
+
+// one little endian file per column (time.u32, source.u32, message.u16, value.i64), which can be
+// mapped directly by analysis tools. NonNASA rows have no numeric value and are left out.
+class ColumnOutput : public RowOutput
+{
+public:
+    bool open(const std::string &dir)
+    {
+        time_.open(dir + "/time.u32", ios::binary);
+        source_.open(dir + "/source.u32", ios::binary);
+        message_.open(dir + "/message.u16", ios::binary);
+        value_.open(dir + "/value.i64", ios::binary);
+        return time_ && source_ && message_ && value_;
+    }
+
+    void write(const std::vector<DecodedRow> &rows) override
+    {
+        for (const auto &row : rows)
+        {
+            if (!row.text.empty())
+                continue;
+            put(time_, row.time, 4);
+            put(source_, row.source, 4);
+            put(message_, row.message, 2);
+            put(value_, (uint64_t)row.value, 8);
+        }
+    }
+
+protected:
+    static void put(std::ofstream &out, uint64_t value, size_t size)
+    {
+        char bytes[8];
+        for (size_t i = 0; i < size; i++)
+            bytes[i] = (char)(value >> (8 * i));
+        out.write(bytes, size);
+    }
+
+    std::ofstream time_;
+    std::ofstream source_;
+    std::ofstream message_;
+    std::ofstream value_;
+};
+
+int main(int argc, char *argv[])
+{
+    unsigned threads = std::thread::hardware_concurrency();
+    const char *columns = nullptr;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc)
+            columns = argv[++i];
+        else
+            path = argv[i];
+    }
+    if (path == nullptr)
+    {
+        cerr << "usage: " << argv[0] << " [--threads <n>] [--columns <dir>] <capture or raw bus dump>" << endl;
+        cerr << "writes csv to stdout unless --columns is given" << endl;
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+
+    FrameSource source;
+    if (!source.open(path))
+    {
+        cerr << "could not open " << path << endl;
+        return 1;
+    }
+
+    CsvOutput csv(cout);
+    ColumnOutput column_output;
+    RowOutput *output = &csv;
+    if (columns != nullptr)
+    {
+        if (!column_output.open(columns))
+        {
+            cerr << "could not create the column files in " << columns << endl;
+            return 1;
+        }
+        output = &column_output;
+    }
+
+    size_t rows = 0;
+    WorkStealingPool pool(threads);
+    size_t invalid = decode_frames(source.frames, pool, [output, &rows](const std::vector<DecodedRow> &decoded)
+                                   {
+        output->write(decoded);
+        rows += decoded.size(); });
+    cout.flush();
+
+    const size_t frames = source.frames.size();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << frames << " frames, " << rows << " values, " << invalid << " rejected by the decoder, "
+         << source.skipped << " bytes outside of frames" << endl;
+    cerr << pool.threads() << " threads, " << seconds << " s, " << (size_t)(frames / std::max(seconds, 1e-9)) << " frames/s" << endl;
+    return 0;
+}
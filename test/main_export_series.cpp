@@ -0,0 +1,57 @@
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include "host_platform.h"
+#include "frame_decoder.h"
+#include "series_store.h"
+
+using namespace std;
+
+// decodes a capture or raw bus dump into a series store for query_series
+int main(int argc, char *argv[])
+{
+    unsigned threads = std::thread::hardware_concurrency();
+    std::vector<const char *> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else
+            paths.push_back(argv[i]);
+    }
+    if (paths.size() != 2)
+    {
+        cerr << "usage: " << argv[0] << " [--threads <n>] <capture or raw bus dump> <series file>" << endl;
+        return 1;
+    }
+
+    FrameSource source;
+    if (!source.open(paths[0]))
+    {
+        cerr << "could not open " << paths[0] << endl;
+        return 1;
+    }
+
+    // NonNASA rows have no numeric value and are not exported
+    SeriesWriter writer;
+    size_t points = 0;
+    WorkStealingPool pool(threads);
+    size_t invalid = decode_frames(source.frames, pool, [&writer, &points](const std::vector<DecodedRow> &rows)
+                                   {
+        for (const auto &row : rows)
+        {
+            if (!row.text.empty())
+                continue;
+            writer.add(row.source, row.message, row.time, row.value);
+            points++;
+        } });
+
+    if (!writer.write(paths[1]))
+    {
+        cerr << "could not write " << paths[1] << endl;
+        return 1;
+    }
+
+    cout << source.frames.size() << " frames, " << points << " points, " << invalid << " rejected by the decoder" << endl;
+    return 0;
+}
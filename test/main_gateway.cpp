@@ -0,0 +1,532 @@
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include "host_platform.h"
+#include "../components/samsung_ac/samsung_ac.h"
+
+using namespace std;
+using namespace esphome;
+using namespace esphome::samsung_ac;
+
+// Runs the component natively as a gateway for one or more buses, e.g.
+//   gateway --state-dir /var/lib/samsung_ac hall=/dev/ttyUSB0:20.00.00,20.00.01 shop=/dev/ttyUSB1@2400:00
+// States are printed as "<bus> state <address>/<entity> <value>", commands are read from stdin
+// as "<bus> <address>/<entity> <value>", e.g. "hall 20.00.00/power ON" or
+// "hall 20.00.00/climate mode=COOL".
+//
+// The protocols keep their state (detected protocol, NonNASA registration, packets in flight) in
+// globals, so every bus runs in a worker process of its own, which is supervised by one epoll loop.
+// perf record -g follows the workers.
+
+struct BusConfig
+{
+    string name;
+    string port;
+    uint32_t baud_rate = 9600;
+    vector<string> addresses;
+};
+
+struct GatewayOptions
+{
+    string state_dir = ".";
+    int log_level = ESPHOME_LOG_LEVEL_INFO;
+    bool passive = false;
+    bool rx_task = false;
+    uint32_t restart_delay = 5000;
+};
+
+// name=port[@baud][:address,address...]
+bool parse_bus(const string &spec, BusConfig &bus)
+{
+    size_t equals = spec.find('=');
+    if (equals == string::npos || equals == 0)
+        return false;
+    bus.name = spec.substr(0, equals);
+
+    string rest = spec.substr(equals + 1);
+    size_t colon = rest.find(':');
+    if (colon != string::npos)
+    {
+        stringstream addresses(rest.substr(colon + 1));
+        string address;
+        while (getline(addresses, address, ','))
+        {
+            if (pack_address(address) == invalidPackedAddress)
+            {
+                cerr << "invalid address " << address << endl;
+                return false;
+            }
+            bus.addresses.push_back(address);
+        }
+        rest = rest.substr(0, colon);
+    }
+
+    size_t at = rest.find('@');
+    if (at != string::npos)
+    {
+        bus.baud_rate = strtoul(rest.substr(at + 1).c_str(), nullptr, 10);
+        rest = rest.substr(0, at);
+    }
+    bus.port = rest;
+    return !bus.port.empty();
+}
+
+/* worker, runs the component for one bus */
+
+class GatewayBus
+{
+public:
+    void setup(const BusConfig &config, const GatewayOptions &options)
+    {
+        EntityBase::on_publish = [](const EntityBase *entity, const string &state)
+        {
+            printf("state %s %s\n", entity->get_name().c_str(), state.c_str());
+        };
+
+        ac_.set_uart_parent(&uart_);
+        ac_.set_update_interval(30000);
+        ac_.set_passive(options.passive);
+        ac_.set_rx_task(options.rx_task);
+        for (const auto &address : config.addresses)
+            add_device(address);
+        App.register_component(&ac_);
+    }
+
+    bool open(const BusConfig &config)
+    {
+        return uart_.open(config.port, config.baud_rate, uart::UART_CONFIG_PARITY_EVEN);
+    }
+
+    int fd() const
+    {
+        return uart_.get_fd();
+    }
+
+    bool fill()
+    {
+        return uart_.fill();
+    }
+
+    // "<address>/<entity> <value>"
+    void command(const string &line)
+    {
+        size_t space = line.find(' ');
+        auto control = controls_.find(line.substr(0, space));
+        if (space == string::npos || control == controls_.end())
+        {
+            printf("error unknown command %s\n", line.c_str());
+            return;
+        }
+        control->second(line.substr(space + 1));
+    }
+
+protected:
+    template <typename T>
+    T *create(const string &address, const string &entity)
+    {
+        T *value = new T();
+        value->set_name(address + "/" + entity);
+        entities_.push_back(unique_ptr<EntityBase>(value));
+        return value;
+    }
+
+    void add_device(const string &address)
+    {
+        auto device = new Samsung_AC_Device(address, &ac_);
+        devices_.push_back(unique_ptr<Samsung_AC_Device>(device));
+
+        device->set_availability_sensor(create<binary_sensor::BinarySensor>(address, "available"));
+        device->set_error_code_sensor(create<sensor::Sensor>(address, "error_code"));
+
+        if (get_address_type(address) == AddressType::Outdoor)
+        {
+            device->set_outdoor_temperature_sensor(create<sensor::Sensor>(address, "outdoor_temperature"));
+            ac_.register_device(device);
+            return;
+        }
+
+        device->set_room_temperature_sensor(create<sensor::Sensor>(address, "room_temperature"));
+        device->set_command_latency_sensor(create<sensor::Sensor>(address, "command_latency"));
+
+        auto power = create<Samsung_AC_Switch>(address, "power");
+        device->set_power_switch(power);
+        controls_[power->get_name()] = [power](const string &value)
+        { value == "ON" ? power->turn_on() : power->turn_off(); };
+
+        auto mode = create<Samsung_AC_Mode_Select>(address, "mode");
+        device->set_mode_select(mode);
+        controls_[mode->get_name()] = [mode](const string &value)
+        { mode->make_call().set_option(value).perform(); };
+
+        auto target = create<Samsung_AC_Number>(address, "target_temperature");
+        device->set_target_temperature_number(target);
+        controls_[target->get_name()] = [target](const string &value)
+        { target->make_call().set_value(atof(value.c_str())).perform(); };
+
+        auto climate = create<Samsung_AC_Climate>(address, "climate");
+        device->set_climate(climate);
+        controls_[climate->get_name()] = [climate](const string &value)
+        { climate_command(climate, value); };
+
+        ac_.register_device(device);
+    }
+
+    // "mode=COOL", "target=22.5" or "fan=AUTO"
+    static void climate_command(Samsung_AC_Climate *climate, const string &value)
+    {
+        size_t equals = value.find('=');
+        string key = value.substr(0, equals);
+        string argument = equals == string::npos ? "" : value.substr(equals + 1);
+        auto call = climate->make_call();
+
+        if (key == "target")
+            call.set_target_temperature(atof(argument.c_str()));
+        else if (key == "mode")
+        {
+            for (uint8_t i = climate::CLIMATE_MODE_OFF; i <= climate::CLIMATE_MODE_AUTO; i++)
+            {
+                if (argument == climate::climate_mode_to_string((climate::ClimateMode)i))
+                    call.set_mode((climate::ClimateMode)i);
+            }
+        }
+        else if (key == "fan")
+        {
+            for (uint8_t i = climate::CLIMATE_FAN_ON; i <= climate::CLIMATE_FAN_QUIET; i++)
+            {
+                if (argument == climate::climate_fan_mode_to_string((climate::ClimateFanMode)i))
+                    call.set_fan_mode((climate::ClimateFanMode)i);
+            }
+        }
+        call.perform();
+    }
+
+    uart::HostUARTComponent uart_;
+    Samsung_AC ac_;
+    vector<unique_ptr<Samsung_AC_Device>> devices_;
+    vector<unique_ptr<EntityBase>> entities_;
+    map<string, function<void(const string &)>> controls_;
+};
+
+// reads whole lines from a non-blocking fd, returns false on end of file
+template <typename F>
+bool read_lines(int fd, string &buffer, F on_line)
+{
+    char data[1024];
+    while (true)
+    {
+        ssize_t size = read(fd, data, sizeof(data));
+        if (size == 0)
+            return false;
+        if (size < 0)
+            return errno == EAGAIN || errno == EINTR;
+
+        buffer.append(data, size);
+        size_t newline;
+        while ((newline = buffer.find('\n')) != string::npos)
+        {
+            string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty())
+                on_line(line);
+        }
+    }
+}
+
+void set_nonblocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+int run_bus(const BusConfig &config, const GatewayOptions &options)
+{
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    log_level = options.log_level;
+    global_preferences = new FilePreferences(options.state_dir + "/" + config.name + ".prefs");
+
+    GatewayBus bus;
+    if (!bus.open(config))
+        return 1;
+    bus.setup(config, options);
+    App.setup();
+
+    int epoll = epoll_create1(0);
+    epoll_event event{};
+    // the RX task reads the port itself, only a hangup is reported then
+    event.events = options.rx_task ? 0 : EPOLLIN;
+    event.data.fd = bus.fd();
+    epoll_ctl(epoll, EPOLL_CTL_ADD, bus.fd(), &event);
+    event.events = EPOLLIN;
+    event.data.fd = STDIN_FILENO;
+    set_nonblocking(STDIN_FILENO);
+    epoll_ctl(epoll, EPOLL_CTL_ADD, STDIN_FILENO, &event);
+
+    string input;
+    uint32_t last_data = 0;
+    while (true)
+    {
+        // the component handles one frame per loop, so loop quickly while the bus is busy.
+        // With the RX task it takes all frames the task collected in the meantime.
+        const int timeout = options.rx_task ? 5 : millis() - last_data < 100 ? 1 : 16;
+        epoll_event events[2];
+        int count = epoll_wait(epoll, events, 2, timeout);
+        for (int i = 0; i < count; i++)
+        {
+            if (events[i].data.fd == STDIN_FILENO)
+            {
+                if (!read_lines(STDIN_FILENO, input, [&](const string &line)
+                                { bus.command(line); }))
+                    return 0; // the supervisor is gone
+            }
+            else
+            {
+                if (options.rx_task ? (events[i].events & EPOLLHUP) != 0 : !bus.fill())
+                {
+                    ESP_LOGE("gateway", "Serial port %s closed", config.port.c_str());
+                    return 2;
+                }
+                last_data = millis();
+            }
+        }
+        App.loop();
+    }
+}
+
+/* supervisor, one worker process per bus */
+
+struct Worker
+{
+    BusConfig config;
+    pid_t pid = 0;
+    int input = -1;  // stdin of the worker
+    int output = -1; // stdout of the worker
+    string buffer;
+    uint32_t restart_at = 0;
+};
+
+bool start_worker(Worker &worker, const GatewayOptions &options, int epoll)
+{
+    int input[2], output[2];
+    if (pipe(input) != 0 || pipe(output) != 0)
+        return false;
+
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0)
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigprocmask(SIG_SETMASK, &signals, nullptr);
+        signal(SIGPIPE, SIG_DFL);
+
+        dup2(input[0], STDIN_FILENO);
+        dup2(output[1], STDOUT_FILENO);
+        close(input[0]);
+        close(input[1]);
+        close(output[0]);
+        close(output[1]);
+        close(epoll);
+        int status = run_bus(worker.config, options);
+        fflush(stdout);
+        _exit(status);
+    }
+
+    close(input[0]);
+    close(output[1]);
+    worker.pid = pid;
+    worker.input = input[1];
+    worker.output = output[0];
+    set_nonblocking(worker.output);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = worker.output;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, worker.output, &event);
+    cout << worker.config.name << " started on " << worker.config.port << " (pid " << pid << ")" << endl;
+    return true;
+}
+
+void print_output(Worker &worker)
+{
+    read_lines(worker.output, worker.buffer, [&](const string &line)
+               { cout << worker.config.name << " " << line << '\n'; });
+    cout.flush();
+}
+
+void close_worker(Worker &worker, int epoll)
+{
+    if (worker.output >= 0)
+    {
+        epoll_ctl(epoll, EPOLL_CTL_DEL, worker.output, nullptr);
+        close(worker.output);
+    }
+    if (worker.input >= 0)
+        close(worker.input);
+    worker.input = worker.output = -1;
+    worker.buffer.clear();
+}
+
+int supervise(vector<Worker> &workers, const GatewayOptions &options)
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGCHLD);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+    int signal_fd = signalfd(-1, &signals, SFD_NONBLOCK);
+
+    int epoll = epoll_create1(0);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = signal_fd;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, signal_fd, &event);
+    event.data.fd = STDIN_FILENO;
+    set_nonblocking(STDIN_FILENO);
+    epoll_ctl(epoll, EPOLL_CTL_ADD, STDIN_FILENO, &event);
+
+    for (auto &worker : workers)
+    {
+        if (!start_worker(worker, options, epoll))
+            worker.restart_at = millis() + options.restart_delay;
+    }
+
+    string input;
+    bool running = true;
+    while (running)
+    {
+        int timeout = -1;
+        for (const auto &worker : workers)
+        {
+            if (worker.pid == 0)
+                timeout = max<int>(0, min<int>(timeout < 0 ? INT32_MAX : timeout, worker.restart_at - millis()));
+        }
+
+        epoll_event events[16];
+        int count = epoll_wait(epoll, events, 16, timeout);
+        for (int i = 0; i < count; i++)
+        {
+            const int fd = events[i].data.fd;
+            if (fd == signal_fd)
+            {
+                signalfd_siginfo info;
+                while (read(signal_fd, &info, sizeof(info)) == sizeof(info))
+                {
+                    if (info.ssi_signo != SIGCHLD)
+                        running = false;
+                }
+
+                pid_t pid;
+                int status;
+                while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+                {
+                    for (auto &worker : workers)
+                    {
+                        if (worker.pid != pid)
+                            continue;
+                        print_output(worker);
+                        if (WIFSIGNALED(status))
+                            cout << worker.config.name << " stopped by signal " << WTERMSIG(status) << endl;
+                        else
+                            cout << worker.config.name << " stopped with status " << WEXITSTATUS(status) << endl;
+                        close_worker(worker, epoll);
+                        worker.pid = 0;
+                        worker.restart_at = millis() + options.restart_delay;
+                    }
+                }
+            }
+            else if (fd == STDIN_FILENO)
+            {
+                // "<bus> <command>", stdin may also be closed when running as a service
+                if (!read_lines(STDIN_FILENO, input, [&](const string &line)
+                                {
+                    size_t space = line.find(' ');
+                    for (auto &worker : workers)
+                    {
+                        if (worker.input >= 0 && line.compare(0, space, worker.config.name) == 0 && space == worker.config.name.size())
+                        {
+                            string command = line.substr(space + 1) + "\n";
+                            if (write(worker.input, command.data(), command.size()) < 0)
+                                cout << worker.config.name << " does not accept commands" << endl;
+                            return;
+                        }
+                    }
+                    cout << "unknown bus in " << line << endl; }))
+                    epoll_ctl(epoll, EPOLL_CTL_DEL, STDIN_FILENO, nullptr);
+            }
+            else
+            {
+                for (auto &worker : workers)
+                {
+                    // end of file is handled with SIGCHLD
+                    if (worker.output == fd)
+                        print_output(worker);
+                }
+            }
+        }
+
+        for (auto &worker : workers)
+        {
+            if (running && worker.pid == 0 && (int32_t)(millis() - worker.restart_at) >= 0)
+            {
+                if (!start_worker(worker, options, epoll))
+                    worker.restart_at = millis() + options.restart_delay;
+            }
+        }
+    }
+
+    for (auto &worker : workers)
+    {
+        if (worker.pid != 0)
+            kill(worker.pid, SIGTERM);
+    }
+    while (wait(nullptr) > 0)
+        ;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    GatewayOptions options;
+    vector<Worker> workers;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--state-dir") == 0 && i + 1 < argc)
+            options.state_dir = argv[++i];
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+            options.log_level = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--passive") == 0)
+            options.passive = true;
+        else if (strcmp(argv[i], "--rx-task") == 0)
+            options.rx_task = true;
+        else
+        {
+            Worker worker;
+            if (!parse_bus(argv[i], worker.config))
+            {
+                workers.clear();
+                break;
+            }
+            workers.push_back(worker);
+        }
+    }
+
+    if (workers.empty())
+    {
+        cerr << "usage: " << argv[0] << " [--state-dir dir] [--log-level 0-6] [--passive] [--rx-task] <name>=<serial port>[@<baud>][:<address>,...]..." << endl;
+        return 1;
+    }
+    return supervise(workers, options);
+}
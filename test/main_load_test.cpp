@@ -0,0 +1,191 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "esphome/core/log.h"
+#include "virtual_target.h"
+#include "bus_simulator.h"
+
+using namespace std;
+
+// Runs the protocol against a simulated bus and reports command latency, retries and cpu time per
+// frame, e.g. load_test --minutes 30 --crc-errors 0.01 --collisions 0.01
+// The component and the simulator are connected by an in-process byte pipe on the virtual clock,
+// bus_simulator --pty offers the same bus on a pseudo-terminal.
+// Exits with 1 if a run misses its limits, so test.sh catches regressions.
+
+struct LoadResult
+{
+    uint32_t commands = 0;
+    uint32_t confirmed = 0;
+    uint64_t latency_sum = 0;
+    uint32_t latency_max = 0;
+    uint64_t frames = 0;
+    double cpu_ms = 0;
+    BusSimulatorStats bus;
+};
+
+void reset_protocol(bool nasa)
+{
+    protocol_processing = nasa ? ProtocolProcessing::NASA : ProtocolProcessing::NonNASA;
+    controller_registered = false;
+    indoor_unit_awake = true;
+    for (auto &item : nonnasa_requests)
+        item.active = false;
+}
+
+LoadResult run_load(const BusSimulatorOptions &options, uint32_t minutes)
+{
+    reset_protocol(options.nasa);
+
+    VirtualTarget target;
+    BusSimulator sim(options, target.clock());
+    Protocol *protocol = get_protocol(options.nasa ? "20.00.00" : "00");
+    LoadResult result;
+
+    // the command interval is spread over the units, every unit gets one per 10 s at most
+    const uint32_t command_interval = max<uint32_t>(10000 / options.indoor_units, 200);
+    const uint32_t start = target.clock().now();
+    uint32_t next_command = start + 5000;
+    size_t next_unit = 0;
+    size_t forwarded = target.sent.size();
+    vector<uint32_t> pending(sim.units().size(), 0); // time of the unconfirmed command per unit
+    vector<vector<uint8_t>> frames;
+    uint32_t tick = 0;
+
+    target.clock().run(minutes * 60 * 1000, 10, [&]()
+                       {
+        const uint32_t now = target.clock().now();
+        tick++;
+
+        frames.clear();
+        sim.update(frames);
+        auto begin = chrono::steady_clock::now();
+        for (const auto &frame : frames)
+            result.frames += target.receive(frame);
+        if (tick % 20 == 0)
+            protocol->protocol_update(&target);
+        result.cpu_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+
+        for (; forwarded < target.sent.size(); forwarded++)
+            sim.receive(target.sent[forwarded].data);
+
+        for (size_t i = 0; i < pending.size(); i++)
+        {
+            const auto &unit = sim.units()[i];
+            if (pending[i] == 0 || (int32_t)(unit.last_command - pending[i]) < 0)
+                continue;
+            const uint32_t latency = unit.last_command - pending[i];
+            result.confirmed++;
+            result.latency_sum += latency;
+            result.latency_max = max(result.latency_max, latency);
+            pending[i] = 0;
+        }
+
+        if ((int32_t)(now - next_command) >= 0)
+        {
+            next_command += command_interval;
+            const size_t i = next_unit++ % sim.units().size();
+            auto &unit = sim.units()[i];
+
+            // toggle between 20 and 26 degrees so every command changes the unit
+            const bool warm = options.nasa ? unit.values[(uint16_t)MessageNumber::VAR_in_temp_target_f] < 230 : unit.target_temp < 23;
+            ProtocolRequest request;
+            request.target_temp = warm ? 26 : 20;
+            if (!options.nasa)
+                request.power = true;
+            protocol->publish_request(&target, unit.address, request);
+            pending[i] = now;
+            result.commands++;
+        } });
+
+    result.bus = sim.stats();
+    return result;
+}
+
+// limits of a run, the NonNASA latency is bound by the request_control message every second and
+// a resend after 4.5 s. A command can get lost when all its resends fail, and the last one may
+// still be pending at the end of a run.
+bool passed(const BusSimulatorOptions &options, const LoadResult &result)
+{
+    const uint32_t mean_limit = options.nasa ? 50 : 1500;
+    const uint32_t max_limit = options.nasa ? 1000 : 6000;
+    return result.confirmed >= result.commands * 99 / 100 &&
+           result.confirmed > 0 && result.latency_sum / result.confirmed <= mean_limit &&
+           result.latency_max <= max_limit;
+}
+
+void print_header()
+{
+    cout << left << setw(8) << "bus" << right
+         << setw(6) << "units" << setw(8) << "faults"
+         << setw(10) << "commands" << setw(10) << "applied"
+         << setw(12) << "latency ms" << setw(8) << "max ms"
+         << setw(9) << "retries" << setw(10) << "frames"
+         << setw(12) << "us/frame" << setw(8) << "result" << endl;
+}
+
+void print_result(const BusSimulatorOptions &options, const LoadResult &result, bool ok)
+{
+    const double retries = result.commands > 0 && result.bus.commands_received > result.commands
+                               ? (double)(result.bus.commands_received - result.commands) / result.commands
+                               : 0;
+    cout << left << setw(8) << (options.nasa ? "NASA" : "NonNASA") << right
+         << setw(6) << options.indoor_units
+         << setw(7) << fixed << setprecision(1) << (options.crc_error_rate + options.collision_rate) * 100 << "%"
+         << setw(10) << result.commands << setw(10) << result.confirmed
+         << setw(12) << setprecision(0) << (result.confirmed > 0 ? (double)result.latency_sum / result.confirmed : 0)
+         << setw(8) << result.latency_max
+         << setw(9) << setprecision(2) << retries
+         << setw(10) << result.frames
+         << setw(12) << setprecision(2) << (result.frames > 0 ? result.cpu_ms * 1000 / result.frames : 0)
+         << setw(8) << (ok ? "ok" : "FAILED") << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t minutes = 10;
+    float crc_errors = 0.01;
+    float collisions = 0.01;
+    int log_level = ESPHOME_LOG_LEVEL_NONE; // the protocol logs every frame otherwise
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc)
+            minutes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--crc-errors") == 0 && i + 1 < argc)
+            crc_errors = atof(argv[++i]);
+        else if (strcmp(argv[i], "--collisions") == 0 && i + 1 < argc)
+            collisions = atof(argv[++i]);
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+            log_level = atoi(argv[++i]);
+        else
+        {
+            cerr << "usage: " << argv[0] << " [--minutes n] [--crc-errors rate] [--collisions rate] [--log-level 0-6]" << endl;
+            return 1;
+        }
+    }
+
+    esphome::log_level = log_level;
+    bool all_passed = true;
+    print_header();
+    for (bool nasa : {true, false})
+    {
+        for (unsigned units : {1, 8, 64})
+        {
+            for (bool faults : {false, true})
+            {
+                BusSimulatorOptions options;
+                options.nasa = nasa;
+                options.indoor_units = units;
+                options.crc_error_rate = faults ? crc_errors : 0;
+                options.collision_rate = faults ? collisions : 0;
+                const LoadResult result = run_load(options, minutes);
+                const bool ok = passed(options, result);
+                print_result(options, result, ok);
+                all_passed = all_passed && ok;
+            }
+        }
+    }
+    return all_passed ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+#include <iostream>
+#include <cstdlib>
+#include "series_store.h"
+#include "../components/samsung_ac/device_registry.h"
+
+using namespace std;
+
+// prints time,value of one series, e.g. query_series store.sacs 20.00.00 4203 3600000 7200000
+// or lists all series when only the file is given
+int main(int argc, char *argv[])
+{
+    if (argc != 2 && argc != 4 && argc != 6)
+    {
+        cerr << "usage: " << argv[0] << " <series file> [<source> <message (hex)> [<from ms> <to ms>]]" << endl;
+        return 1;
+    }
+
+    SeriesReader reader;
+    if (!reader.open(argv[1]))
+    {
+        cerr << "could not open series file " << argv[1] << endl;
+        return 1;
+    }
+
+    if (argc == 2)
+    {
+        for (const auto &series : reader.series())
+        {
+            uint32_t points = 0;
+            for (const auto &block : series.blocks)
+                points += block.count;
+            cout << unpack_address(series.source) << " " << long_to_hex(series.message) << " " << points << " points" << endl;
+        }
+        return 0;
+    }
+
+    uint32_t source = pack_address(argv[2]);
+    if (source == invalidPackedAddress)
+    {
+        cerr << "invalid address " << argv[2] << endl;
+        return 1;
+    }
+    uint16_t message = strtoul(argv[3], nullptr, 16);
+    uint32_t from = argc == 6 ? strtoul(argv[4], nullptr, 10) : 0;
+    uint32_t to = argc == 6 ? strtoul(argv[5], nullptr, 10) : 0xFFFFFFFF;
+
+    cout << "time,value\n";
+    size_t found = reader.query(source, message, from, to, [](uint32_t time, int64_t value)
+                                { cout << time << ',' << value << '\n'; });
+    cerr << found << " points" << endl;
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include <iostream>
+#include <fstream>
+#include "raw_stream_receiver.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4)
+    {
+        cerr << "usage: " << argv[0] << " <host> <port> <capture file>" << endl;
+        return 1;
+    }
+
+    int fd = connect_tcp(argv[1], argv[2]);
+    if (fd < 0)
+    {
+        cerr << "could not connect to " << argv[1] << ":" << argv[2] << endl;
+        return 1;
+    }
+
+    ofstream file(argv[3], ios::binary);
+    CaptureReceiver receiver(file);
+    bool valid = receive_stream(fd, receiver);
+    close(fd);
+
+    cout << receiver.frames << " frames written, " << receiver.dropped << " dropped by the device" << endl;
+    if (!valid)
+    {
+        cerr << "not a capture stream" << endl;
+        return 1;
+    }
+    return 0;
+}
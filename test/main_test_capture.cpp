@@ -0,0 +1,145 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include "capture_file.h"
+#include "../components/samsung_ac/device_registry.h"
+
+using namespace std;
+
+const char *capturePath = "test_capture.sacp";
+
+void write_capture(bool with_index)
+{
+    CaptureFileWriter writer;
+    assert(writer.open(capturePath));
+
+    const uint8_t frame1[] = {0x32, 0x00, 0x01, 0x34};
+    const uint8_t frame2[] = {0x32, 0x00, 0x02, 0x34};
+    const uint8_t frame3[] = {0x32, 0x00, 0x03, 0x34};
+
+    uint64_t offset = writer.add(100, CaptureDirection::Received, frame1, sizeof(frame1));
+    assert(offset == captureHeaderSize);
+    if (with_index)
+    {
+        writer.index(pack_address("20.00.02"), captureAnyMessage, offset);
+        writer.index(pack_address("20.00.02"), 0x4203, offset);
+    }
+
+    offset = writer.add(200, CaptureDirection::Received, frame2, sizeof(frame2));
+    assert(offset == captureHeaderSize + captureRecordHeaderSize + sizeof(frame1));
+    if (with_index)
+    {
+        writer.index(pack_address("10.00.00"), captureAnyMessage, offset);
+        writer.index(pack_address("10.00.00"), 0x4203, offset);
+    }
+
+    offset = writer.add(300, CaptureDirection::Sent, frame3, sizeof(frame3));
+    if (with_index)
+    {
+        writer.index(pack_address("20.00.02"), captureAnyMessage, offset);
+        writer.index(pack_address("20.00.02"), 0x4201, offset);
+    }
+
+    assert(writer.close());
+}
+
+void test_without_index()
+{
+    cout << "test_without_index" << endl;
+
+    write_capture(false);
+
+    CaptureFile file;
+    assert(file.open(capturePath));
+    assert(!file.has_index());
+    assert(file.find(pack_address("20.00.02"), captureAnyMessage).empty());
+
+    std::vector<uint32_t> times;
+    file.for_each([&times](uint64_t, const CaptureRecord &record)
+                  { times.push_back(record.time); return true; });
+    assert((times == std::vector<uint32_t>{100, 200, 300}));
+}
+
+void test_with_index()
+{
+    cout << "test_with_index" << endl;
+
+    write_capture(true);
+
+    CaptureFile file;
+    assert(file.open(capturePath));
+    assert(file.has_index());
+
+    // the index is not read as records
+    std::vector<uint32_t> times;
+    file.for_each([&times](uint64_t, const CaptureRecord &record)
+                  { times.push_back(record.time); return true; });
+    assert((times == std::vector<uint32_t>{100, 200, 300}));
+
+    auto offsets = file.find(pack_address("20.00.02"), captureAnyMessage);
+    assert(offsets.size() == 2);
+
+    CaptureRecord record;
+    assert(file.record_at(offsets[0], record));
+    assert(record.time == 100);
+    assert(record.length == 4 && record.data[2] == 0x01);
+    assert(file.record_at(offsets[1], record));
+    assert(record.time == 300);
+    assert(record.direction == CaptureDirection::Sent);
+
+    offsets = file.find(pack_address("20.00.02"), 0x4203);
+    assert(offsets.size() == 1);
+    assert(file.record_at(offsets[0], record));
+    assert(record.time == 100);
+
+    offsets = file.find(pack_address("10.00.00"), 0x4203);
+    assert(offsets.size() == 1);
+    assert(file.record_at(offsets[0], record));
+    assert(record.time == 200);
+
+    assert(file.find(pack_address("10.00.00"), 0x4201).empty());
+    assert(file.find(pack_address("20.00.03"), captureAnyMessage).empty());
+    assert(file.find(pack_address("c8"), captureAnyMessage).empty());
+
+    assert(!file.record_at(0, record));
+    assert(!file.record_at(file.records_end(), record));
+}
+
+void test_trailer()
+{
+    cout << "test_trailer" << endl;
+
+    std::vector<uint8_t> data;
+    append_capture_header(data);
+    const uint8_t frame[] = {0x32, 0x34};
+    append_capture_record(data, 1, CaptureDirection::Received, frame, sizeof(frame));
+
+    std::vector<CaptureIndexEntry> entries = {{0x200000, 0x4000, captureHeaderSize},
+                                              {0x100000, 0x4000, captureHeaderSize}};
+    uint64_t index_offset = data.size();
+    append_capture_index(data, entries, index_offset);
+
+    uint64_t offset;
+    uint32_t count;
+    assert(parse_capture_trailer(data.data(), data.size(), offset, count));
+    assert(offset == index_offset);
+    assert(count == 2);
+
+    // sorted by source
+    assert(read_capture_index_entry(data.data() + offset).source == 0x100000);
+    assert(read_capture_index_entry(data.data() + offset + captureIndexEntrySize).source == 0x200000);
+
+    // a cut off file has no valid index
+    assert(!parse_capture_trailer(data.data() + 1, data.size() - 1, offset, count));
+    data.pop_back();
+    assert(!parse_capture_trailer(data.data(), data.size(), offset, count));
+}
+
+int main(int argc, char *argv[])
+{
+    test_without_index();
+    test_with_index();
+    test_trailer();
+    remove(capturePath);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include "frame_splitter.h"
+#include "work_stealing_pool.h"
+
+using namespace std;
+
+std::vector<uint8_t> nasa_frame(uint8_t packet_number)
+{
+    // 20.00.00 -> b0.ff.20, notification with one enum message 0x4000 = 1
+    std::vector<uint8_t> frame = {0x32, 0x00, 0x00, 0x20, 0x00, 0x00, 0xb0, 0xff, 0x20, 0xc0, 0x14, packet_number, 0x01, 0x40, 0x00, 0x01};
+    frame[2] = frame.size() + 1; // without start and end byte, but with the two crc bytes
+    uint16_t crc = frame_crc16(frame.data() + 3, frame.size() - 3);
+    frame.push_back(crc >> 8);
+    frame.push_back(crc & 0xff);
+    frame.push_back(0x34);
+    return frame;
+}
+
+std::vector<uint8_t> non_nasa_frame(uint8_t cmd)
+{
+    std::vector<uint8_t> frame = {0x32, 0x00, 0xc8, cmd, 0x41, 0x42, 0x43, 0x00, 0x01, 0x00, 0x00, 0x44, 0x00, 0x34};
+    uint8_t sum = frame[1];
+    for (int i = 2; i < 12; i++)
+        sum ^= frame[i];
+    frame[12] = sum;
+    return frame;
+}
+
+void test_valid_frame_length()
+{
+    cout << "test_valid_frame_length" << endl;
+
+    auto nasa = nasa_frame(1);
+    assert(nasa.size() == 19);
+    assert(valid_frame_length(nasa.data(), nasa.size()) == nasa.size());
+    assert(valid_frame_length(nasa.data(), nasa.size() - 1) == 0);
+
+    auto broken = nasa;
+    broken[14] ^= 0xff;
+    assert(valid_frame_length(broken.data(), broken.size()) == 0);
+
+    auto non_nasa = non_nasa_frame(0x20);
+    assert(valid_frame_length(non_nasa.data(), non_nasa.size()) == 14);
+    non_nasa[5] ^= 0x01;
+    assert(valid_frame_length(non_nasa.data(), non_nasa.size()) == 0);
+}
+
+void test_split_frames()
+{
+    cout << "test_split_frames" << endl;
+
+    auto nasa1 = nasa_frame(1);
+    auto nasa2 = nasa_frame(2);
+    auto non_nasa = non_nasa_frame(0xc0);
+
+    std::vector<uint8_t> stream = {0x00, 0x32, 0x55}; // noise and a false start byte
+    stream.insert(stream.end(), nasa1.begin(), nasa1.end());
+    stream.insert(stream.end(), nasa2.begin(), nasa2.end() - 4); // cut off by a collision
+    stream.insert(stream.end(), non_nasa.begin(), non_nasa.end());
+    stream.insert(stream.end(), nasa2.begin(), nasa2.end());
+
+    std::vector<FrameRef> frames;
+    size_t skipped = split_frames(stream.data(), stream.size(), 7, frames);
+    assert(frames.size() == 3);
+    assert(skipped == 3 + nasa2.size() - 4);
+
+    assert(frames[0].data == stream.data() + 3);
+    assert(frames[0].length == nasa1.size());
+    assert(frames[0].time == 7);
+    assert(frames[1].length == 14);
+    assert(frames[1].data[3] == 0xc0);
+    assert(frames[2].length == nasa2.size());
+    assert(frames[2].data[11] == 2);
+}
+
+void test_work_stealing_pool()
+{
+    cout << "test_work_stealing_pool" << endl;
+
+    for (unsigned threads : {1u, 2u, 7u})
+    {
+        WorkStealingPool pool(threads);
+        std::vector<std::atomic<int>> runs(1000);
+        pool.run(runs.size(), [&runs](size_t i)
+                 {
+            // uneven tasks, so stealing is needed
+            if (i < 10)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            runs[i]++; });
+
+        for (auto &count : runs)
+            assert(count == 1);
+    }
+
+    WorkStealingPool pool(4);
+    bool called = false;
+    pool.run(0, [&called](size_t)
+             { called = true; });
+    assert(!called);
+}
+
+int main(int argc, char *argv[])
+{
+    test_valid_frame_length();
+    test_split_frames();
+    test_work_stealing_pool();
+    return 0;
+}
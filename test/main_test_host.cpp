@@ -0,0 +1,153 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include "host_platform.h"
+#include "esphome/components/uart/uart.h"
+#include "esphome/components/number/number.h"
+
+using namespace std;
+using namespace esphome;
+
+struct TestState
+{
+    int16_t value;
+    uint8_t flags;
+};
+
+void test_file_preferences()
+{
+    cout << "test_file_preferences" << endl;
+
+    char path[] = "/tmp/samsung_ac_prefs_XXXXXX";
+    close(mkstemp(path));
+    {
+        FilePreferences preferences(path);
+        auto pref = preferences.make_preference<TestState>(fnv1_hash("state"), true);
+        TestState state{-123, 7};
+        assert(pref.save(&state));
+    }
+
+    // restored by a new process
+    FilePreferences preferences(path);
+    auto pref = preferences.make_preference<TestState>(fnv1_hash("state"), true);
+    TestState state{};
+    assert(pref.load(&state));
+    assert(state.value == -123 && state.flags == 7);
+
+    auto other = preferences.make_preference<TestState>(fnv1_hash("other"), true);
+    assert(!other.load(&state));
+
+    // a changed struct does not load the old value
+    auto changed = preferences.make_preference<uint64_t>(fnv1_hash("state"), true);
+    uint64_t value;
+    assert(!changed.load(&value));
+    unlink(path);
+}
+
+class TestComponent : public PollingComponent
+{
+public:
+    TestComponent() : PollingComponent(50) {}
+
+    void setup() override
+    {
+        set_interval("tick", 10, [this]()
+                     { ticks++; });
+        set_timeout("once", 20, [this]()
+                    { timeouts++; });
+    }
+    void update() override { updates++; }
+    void loop() override { loops++; }
+
+    int ticks = 0, timeouts = 0, updates = 0, loops = 0;
+};
+
+void test_scheduler()
+{
+    cout << "test_scheduler" << endl;
+
+    Application app;
+    TestComponent component;
+    app.register_component(&component);
+    app.setup();
+
+    const uint32_t start = millis();
+    while (millis() - start < 120)
+    {
+        app.loop();
+        delay(1);
+    }
+    assert(component.loops > 50);
+    assert(component.ticks >= 8 && component.ticks <= 12);
+    assert(component.timeouts == 1);
+    assert(component.updates == 2);
+}
+
+void test_host_uart()
+{
+    cout << "test_host_uart" << endl;
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    assert(master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0);
+
+    uart::HostUARTComponent uart;
+    assert(uart.open(ptsname(master), 9600));
+    uart::UARTDevice device(&uart);
+    assert(device.available() == 0);
+
+    const uint8_t frame[] = {0x32, 0x00, 0x11, 0x34};
+    assert(write(master, frame, sizeof(frame)) == sizeof(frame));
+    delay(20);
+    assert(device.available() == 4);
+    uint8_t c;
+    assert(device.peek_byte(&c) && c == 0x32);
+    assert(device.read_byte(&c) && c == 0x32);
+    uint8_t rest[3];
+    assert(device.read_array(rest, 3) && rest[2] == 0x34);
+    assert(!device.read_byte(&c));
+
+    device.write_array(std::vector<uint8_t>{0x32, 0x34});
+    device.flush();
+    uint8_t sent[2];
+    assert(read(master, sent, 2) == 2 && sent[0] == 0x32 && sent[1] == 0x34);
+
+    // the other side is gone
+    close(master);
+    assert(!uart.fill());
+}
+
+class TestNumber : public number::Number
+{
+public:
+    void control(float value) override { publish_state(value); }
+};
+
+void test_entities()
+{
+    cout << "test_entities" << endl;
+
+    std::string published;
+    EntityBase::on_publish = [&](const EntityBase *entity, const std::string &state)
+    { published = entity->get_name() + " " + state; };
+
+    TestNumber number;
+    number.set_name("20.00.00/target_temperature");
+    number.make_call().set_value(22.5).perform();
+    assert(number.state == 22.5f);
+    assert(published == "20.00.00/target_temperature 22.5");
+
+    number.publish_state(NAN);
+    assert(published == "20.00.00/target_temperature unknown");
+    EntityBase::on_publish = nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    test_file_preferences();
+    test_scheduler();
+    test_host_uart();
+    test_entities();
+    return 0;
+}
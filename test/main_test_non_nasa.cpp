@@ -70,7 +70,7 @@ NonNasaDataPacket test_decode(std::string data)
 {
     NonNasaDataPacket p;
     auto bytes = hex_to_bytes(data);
-    assert(p.decode(bytes) == DecodeResult::Ok);
+    assert(p.decode(bytes).type == DecodeResultType::Processed);
     std::cout << p.to_string() << std::endl;
     return p;
 }
@@ -220,6 +220,19 @@ void test_encoding()
     test_request(req, "32d000b01f041404c42100008e34");
 }
 
+void test_frame()
+{
+    NonNasaFrame frame(0xd0, 0xc8, 0xd1);
+    frame.set(4, 0xd2);
+    assert_str(bytes_to_hex(frame.to_vector()), "32d0c8d1d2000000000000001b34");
+
+    // patching a field again must only account for the latest value
+    frame.set(6, 0x55);
+    frame.set(6, 0x14);
+    frame.set(4, 0xd2);
+    assert_str(bytes_to_hex(frame.to_vector()), "32d0c8d1d2001400000000000f34");
+}
+
 void test_target()
 {
     DebugTarget target;
@@ -250,8 +263,6 @@ void test_target()
 
 void test_previous_data_is_used_correctly()
 {
-    debug_log_packets = true;
-
     // Sending package 20 on non nasa requiers to send the previous values
     // these values need to be stored for each address. This test makes sure
     // this process works.
@@ -267,7 +278,7 @@ void test_previous_data_is_used_correctly()
     ProtocolRequest req1;
     req1.power = false;
     get_protocol("00")->publish_request(&target, "00", req1);
-    test_process_data("32c8f0f80345f0c913000000ac34", target); // trigger publish
+    test_process_data("32c8d0c60100000000000000df34", target); // request_control triggers publish
 
     NonNasaRequest request1;
     request1.dst = "00";
@@ -286,7 +297,7 @@ void test_previous_data_is_used_correctly()
     ProtocolRequest req2;
     req2.power = true;
     get_protocol("01")->publish_request(&target, "01", req2);
-    test_process_data("32c8f0f80345f0c913000000ac34", target); // trigger publish
+    test_process_data("32c8d0c60100000000000000df34", target); // request_control triggers publish
 
     NonNasaRequest request2;
     request2.dst = "01";
@@ -298,12 +309,97 @@ void test_previous_data_is_used_correctly()
     assert_str(bytes_to_hex(request2.encode()), target.last_publish_data);
 }
 
+void test_requests_are_merged()
+{
+    std::cout << "test_requests_are_merged" << std::endl;
+
+    DebugTarget target;
+    test_process_data("3200c8204d51500001100051e434", target);
+
+    ProtocolRequest req1;
+    req1.power = true;
+    get_protocol("00")->publish_request(&target, "00", req1);
+
+    ProtocolRequest req2;
+    req2.target_temp = 25;
+    get_protocol("00")->publish_request(&target, "00", req2);
+
+    // both changes end up in one pending request
+    int pending = 0;
+    for (auto &item : nonnasa_requests)
+    {
+        if (!item.active || item.request.dst != "00")
+            continue;
+        pending++;
+        assert(item.request.power == true);
+        assert(item.request.target_temp == 25);
+        assert_str(bytes_to_hex(item.frame.to_vector()), bytes_to_hex(item.request.encode()));
+        item.active = false;
+    }
+    assert(pending == 1);
+}
+
+NonNasaRequestQueueItem *pending_request(const std::string &address)
+{
+    for (auto &item : nonnasa_requests)
+    {
+        if (item.active && item.request.dst == address)
+            return &item;
+    }
+    return nullptr;
+}
+
+void test_full_queue_drops_the_oldest_request()
+{
+    std::cout << "test_full_queue_drops_the_oldest_request" << std::endl;
+
+    for (auto &item : nonnasa_requests)
+        item.active = false;
+
+    DebugTarget target;
+    char address[3];
+    for (size_t i = 0; i < NONNASA_REQUEST_SLOTS; i++)
+    {
+        target.miliseconds = 100 + i;
+        ProtocolRequest req;
+        req.power = true;
+        snprintf(address, sizeof(address), "%02x", (unsigned)(0x10 + i));
+        get_protocol(address)->publish_request(&target, address, req);
+    }
+
+    // a merged change requeues the request, so 11 is the oldest now
+    target.miliseconds = 200;
+    ProtocolRequest merged;
+    merged.target_temp = 23;
+    get_protocol("10")->publish_request(&target, "10", merged);
+
+    target.miliseconds = 201;
+    ProtocolRequest req;
+    req.power = false;
+    get_protocol("30")->publish_request(&target, "30", req);
+
+    assert(pending_request("11") == nullptr);
+    assert(pending_request("10") != nullptr && pending_request("10")->request.target_temp == 23);
+    assert(pending_request("30") != nullptr && pending_request("30")->time == 201);
+    for (size_t i = 2; i < NONNASA_REQUEST_SLOTS; i++)
+    {
+        snprintf(address, sizeof(address), "%02x", (unsigned)(0x10 + i));
+        assert(pending_request(address) != nullptr);
+    }
+
+    for (auto &item : nonnasa_requests)
+        item.active = false;
+}
+
 int main(int argc, char *argv[])
 {
     // test_read_file();
     test_decoding();
     test_encoding();
+    test_frame();
     test_target();
 
     test_previous_data_is_used_correctly();
+    test_requests_are_merged();
+    test_full_queue_drops_the_oldest_request();
 };
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <cassert>
+#include <netinet/in.h>
+#include "raw_stream_receiver.h"
+
+using namespace std;
+
+// stands in for the device: a loopback server which sends a capture stream in small pieces
+void serve(int server, std::vector<uint8_t> stream)
+{
+    int client = accept(server, nullptr, nullptr);
+    for (size_t i = 0; i < stream.size(); i += 3)
+    {
+        write(client, stream.data() + i, std::min((size_t)3, stream.size() - i));
+    }
+    close(client);
+}
+
+std::vector<uint8_t> create_stream()
+{
+    const uint8_t nasa[] = {0x32, 0x00, 0x11, 0x10, 0x00, 0x00, 0xb0, 0x00, 0xff, 0xc0, 0x14, 0x11, 0x01, 0x34};
+    const uint8_t non_nasa[] = {0x32, 0xc8, 0x00, 0x20, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x34};
+
+    std::vector<uint8_t> stream;
+    append_capture_header(stream);
+    append_capture_record(stream, 1000, CaptureDirection::Received, nasa, sizeof(nasa));
+    append_capture_record(stream, 1100, CaptureDirection::Sent, non_nasa, sizeof(non_nasa));
+    append_capture_dropped(stream, 1200, 5);
+    append_capture_record(stream, 70000, CaptureDirection::Discarded, nasa, 3);
+    return stream;
+}
+
+void test_capture_format()
+{
+    cout << "test_capture_format" << endl;
+
+    auto stream = create_stream();
+    assert(is_capture_header(stream.data(), stream.size()));
+
+    CaptureRecord record;
+    size_t offset = captureHeaderSize;
+    size_t length = parse_capture_record(stream.data() + offset, stream.size() - offset, record);
+    assert(length == captureRecordHeaderSize + 14);
+    assert(record.time == 1000);
+    assert(record.direction == CaptureDirection::Received);
+    assert(record.length == 14 && record.data[0] == 0x32 && record.data[13] == 0x34);
+
+    // incomplete records are left for later
+    assert(parse_capture_record(stream.data() + offset, length - 1, record) == 0);
+}
+
+void test_receive_loopback()
+{
+    cout << "test_receive_loopback" << endl;
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    assert(bind(server, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    assert(listen(server, 1) == 0);
+    socklen_t addr_len = sizeof(addr);
+    getsockname(server, (struct sockaddr *)&addr, &addr_len);
+
+    auto stream = create_stream();
+    std::thread device(serve, server, stream);
+
+    int fd = connect_tcp("127.0.0.1", std::to_string(ntohs(addr.sin_port)));
+    assert(fd >= 0);
+
+    std::ostringstream file;
+    CaptureReceiver receiver(file);
+    assert(receive_stream(fd, receiver));
+    close(fd);
+    device.join();
+    close(server);
+
+    assert(receiver.frames == 3);
+    assert(receiver.dropped == 5);
+    assert(receiver.incomplete() == 0);
+    assert(file.str() == std::string(stream.begin(), stream.end()));
+}
+
+void test_invalid_stream()
+{
+    cout << "test_invalid_stream" << endl;
+
+    std::ostringstream file;
+    CaptureReceiver receiver(file);
+    const uint8_t log_line[] = "[D][samsung_ac]";
+    assert(!receiver.feed(log_line, sizeof(log_line)));
+}
+
+int main(int argc, char *argv[])
+{
+    test_capture_format();
+    test_receive_loopback();
+    test_invalid_stream();
+};
@@ -0,0 +1,155 @@
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include "../components/samsung_ac/device_registry.h"
+
+using namespace std;
+using namespace esphome::samsung_ac;
+
+struct TestDevice
+{
+    std::string address;
+};
+
+void test_pack_address()
+{
+    cout << "test_pack_address" << endl;
+
+    assert(pack_address("20.00.00") == 0x200000);
+    assert(pack_address("10.00.01") == 0x100001);
+    assert(pack_address("c8") == (nonNasaAddressFlag | 0xc8));
+    assert(pack_address("") == invalidPackedAddress);
+    assert(pack_address("20.00") == invalidPackedAddress);
+
+    assert(unpack_address(pack_address("20.00.3f")) == "20.00.3f");
+    assert(unpack_address(pack_address("10.00.00")) == "10.00.00");
+    assert(unpack_address(pack_address("00")) == "00");
+    assert(unpack_address(pack_address("c8")) == "c8");
+
+    // NonNASA "00" must not collide with NASA "00.00.00"
+    assert(pack_address("00") != pack_address("00.00.00"));
+}
+
+void test_discovery_registry()
+{
+    cout << "test_discovery_registry" << endl;
+
+    std::vector<std::pair<PackedAddress, DiscoveryEvent>> events;
+    DiscoveryRegistry registry;
+    registry.add_on_change_callback([&events](const DiscoveredAddress &entry, DiscoveryEvent event)
+                                    { events.push_back({entry.address, event}); });
+
+    const PackedAddress indoor = pack_address("20.00.01");
+    const PackedAddress outdoor = pack_address("10.00.00");
+
+    assert(!registry.seen(indoor, 100));
+    registry.add(indoor, AddressType::Indoor, 100);
+    registry.add(outdoor, AddressType::Outdoor, 200);
+    assert(registry.seen(indoor, 300));
+    assert(registry.size() == 2);
+    assert(events.size() == 2);
+    assert(events[0].first == indoor && events[0].second == DiscoveryEvent::Added);
+
+    // iteration is sorted, so the stored topology does not depend on discovery order
+    assert(registry.begin()->address == outdoor);
+    assert(registry.begin()->type == AddressType::Outdoor);
+
+    const DiscoveredAddress *entry = registry.find(indoor);
+    assert(entry != nullptr && entry->first_seen == 100 && entry->last_seen == 300);
+    assert(registry.find(pack_address("20.00.02")) == nullptr);
+
+    // the outdoor unit went quiet
+    assert(registry.seen(indoor, 1000));
+    registry.expire(1500, 1000);
+    assert(events.size() == 3);
+    assert(events[2].first == outdoor && events[2].second == DiscoveryEvent::Removed);
+    assert(!registry.find(outdoor)->online);
+    assert(registry.find(indoor)->online);
+    assert(registry.size() == 2);
+
+    // and is back
+    registry.expire(1500, 1000);
+    assert(registry.seen(outdoor, 2000));
+    assert(events.size() == 4);
+    assert(events[3].first == outdoor && events[3].second == DiscoveryEvent::Added);
+    assert(registry.find(outdoor)->first_seen == 2000);
+
+    // restored addresses stay quiet until their first frame
+    registry.restore(pack_address("20.00.02"), AddressType::Indoor);
+    assert(events.size() == 4);
+    assert(!registry.find(pack_address("20.00.02"))->online);
+    assert(registry.seen(pack_address("20.00.02"), 2100));
+    assert(events.size() == 5);
+}
+
+void test_registry_64_devices()
+{
+    cout << "test_registry_64_devices" << endl;
+
+    std::vector<TestDevice> devices(64);
+    for (int i = 0; i < 64; i++)
+    {
+        char address[9];
+        // register in an order which is not sorted by address
+        snprintf(address, sizeof(address), "20.00.%02x", (i * 37) % 64);
+        devices[i].address = address;
+    }
+
+    DeviceRegistry<TestDevice *> registry;
+    for (int i = 0; i < 64; i++)
+    {
+        uint8_t handle = registry.add(pack_address(devices[i].address), &devices[i]);
+        assert(handle == i);
+    }
+    assert(registry.size() == 64);
+
+    // duplicates are rejected and do not change the handles
+    assert(registry.add(pack_address("20.00.00"), &devices[0]) == DeviceRegistry<TestDevice *>::invalidHandle);
+    assert(registry.size() == 64);
+
+    for (int i = 0; i < 64; i++)
+    {
+        PackedAddress address = pack_address(devices[i].address);
+        assert(registry.find(address) == &devices[i]);
+        assert(registry.find_handle(address) == i);
+        assert(registry.get(i) == &devices[i]);
+        assert(registry.get_address(i) == address);
+    }
+
+    assert(registry.find(pack_address("20.00.40")) == nullptr);
+    assert(registry.find(pack_address("00")) == nullptr);
+    assert(registry.find_handle(pack_address("10.00.00")) == DeviceRegistry<TestDevice *>::invalidHandle);
+
+    // iteration is in registration order
+    int i = 0;
+    for (TestDevice *device : registry)
+        assert(device == &devices[i++]);
+    assert(i == 64);
+
+    // pointer, packed address and index byte per device plus a bit of slack from the vectors
+    size_t usage = registry.memory_usage();
+    cout << "registry memory for 64 devices: " << usage << " bytes" << endl;
+    assert(usage <= sizeof(registry) + 2 * 64 * (sizeof(TestDevice *) + sizeof(PackedAddress) + 1));
+}
+
+void test_registry_is_full()
+{
+    cout << "test_registry_is_full" << endl;
+
+    TestDevice device;
+    DeviceRegistry<TestDevice *> registry;
+    for (int i = 0; i < 255; i++)
+    {
+        assert(registry.add(i, &device) == i);
+    }
+    assert(registry.add(1000, &device) == DeviceRegistry<TestDevice *>::invalidHandle);
+}
+
+int main(int argc, char *argv[])
+{
+    test_pack_address();
+    test_discovery_registry();
+    test_registry_64_devices();
+    test_registry_is_full();
+};
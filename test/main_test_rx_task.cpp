@@ -0,0 +1,266 @@
+#include <iostream>
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "host_platform.h"
+#include "frame_splitter.h"
+#include "../components/samsung_ac/rx_task.h"
+#include "../components/samsung_ac/frame.h"
+#include "../components/samsung_ac/protocol_nasa.h"
+#include "../components/samsung_ac/protocol_non_nasa.h"
+
+using namespace std;
+using namespace esphome;
+using namespace esphome::samsung_ac;
+
+// Run with -fsanitize=thread, see test_rx_task.sh
+
+std::vector<uint8_t> nasa_frame(int value)
+{
+    return Packet::create(Address::parse("20.00.00"), DataType::Request, MessageNumber::VAR_in_temp_target_f, value).encode();
+}
+
+std::vector<uint8_t> non_nasa_frame(uint8_t src, uint8_t dst, uint8_t value)
+{
+    NonNasaFrame frame(src, dst, 0x20);
+    frame.set(4, value);
+    return frame.to_vector();
+}
+
+int frame_length(const std::vector<uint8_t> &data)
+{
+    return frame_length(data.data(), data.size());
+}
+
+void test_frame_length()
+{
+    cout << "test_frame_length" << endl;
+
+    auto nasa = nasa_frame(220);
+    assert(frame_length(nasa) == (int)nasa.size());
+
+    // 00 -> c8 looks like a NASA frame of 200 bytes
+    auto non_nasa = non_nasa_frame(0x00, 0xc8, 0x4b);
+    assert(frame_length(non_nasa) == 14);
+
+    std::vector<uint8_t> data = {0x55, 0x00};
+    data.insert(data.end(), nasa.begin(), nasa.end());
+    assert(frame_length(data) == -2);
+
+    std::vector<uint8_t> partial(nasa.begin(), nasa.end() - 1);
+    assert(frame_length(partial) == 0);
+
+    auto broken = nasa;
+    broken[broken.size() - 3] ^= 0xff;
+    broken.insert(broken.end(), non_nasa.begin(), non_nasa.end());
+    assert(frame_length(broken) == -(int)nasa.size());
+
+    // a NonNASA frame with a broken checksum which could still be the start of a NASA frame of
+    // 200 bytes: the RX task waits for more bytes, the capture splitter has none and skips it
+    auto garbled = non_nasa;
+    garbled[5] ^= 0x01;
+    assert(frame_length(garbled) == 0);
+    std::vector<FrameRef> frames;
+    assert(split_frames(garbled.data(), garbled.size(), 0, frames) == garbled.size() && frames.empty());
+}
+
+void test_spsc_ring()
+{
+    cout << "test_spsc_ring" << endl;
+
+    // records of a length byte and a counter pattern, much more than fits into the ring at once
+    static SpscRing<256> ring;
+    const uint32_t records = 200000;
+
+    std::thread producer([&]()
+                         {
+        uint8_t record[64];
+        for (uint32_t i = 0; i < records; i++)
+        {
+            const uint8_t length = 1 + i % 63;
+            record[0] = length;
+            for (uint8_t j = 1; j <= length; j++)
+                record[j] = (uint8_t)(i + j);
+            while (ring.writable() < (size_t)length + 1)
+                std::this_thread::yield();
+            ring.write(record, 1);
+            ring.write(record + 1, length);
+            if (i % 3 == 0)
+                ring.commit();
+        }
+        ring.commit(); });
+
+    uint8_t record[64];
+    for (uint32_t i = 0; i < records; i++)
+    {
+        while (ring.readable() == 0)
+            std::this_thread::yield();
+        ring.read(record, 1);
+        assert(record[0] == 1 + i % 63);
+        assert(ring.readable() >= record[0]);
+        ring.read(record + 1, record[0]);
+        for (uint8_t j = 1; j <= record[0]; j++)
+            assert(record[j] == (uint8_t)(i + j));
+        ring.release();
+    }
+    producer.join();
+    assert(ring.readable() == 0);
+}
+
+// UART fed by another thread in random pieces, like the driver between interrupts
+class FeedUART : public uart::UARTComponent
+{
+public:
+    void feed(const std::vector<uint8_t> &data)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rx_.insert(rx_.end(), data.begin(), data.end());
+    }
+
+    void write_array(const uint8_t *data, size_t len) override {}
+    void flush() override {}
+
+    bool peek_byte(uint8_t *data) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rx_.empty())
+            return false;
+        *data = rx_.front();
+        return true;
+    }
+
+    bool read_array(uint8_t *data, size_t len) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rx_.size() < len)
+            return false;
+        std::copy(rx_.begin(), rx_.begin() + len, data);
+        rx_.erase(rx_.begin(), rx_.begin() + len);
+        return true;
+    }
+
+    int available() override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rx_.size();
+    }
+
+protected:
+    std::mutex mutex_;
+    std::deque<uint8_t> rx_;
+};
+
+void test_rx_task()
+{
+    cout << "test_rx_task" << endl;
+
+    // a mixed bus with some noise between the frames
+    std::vector<std::vector<uint8_t>> frames;
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 3000; i++)
+    {
+        if (i % 100 == 50)
+            stream.insert(stream.end(), {0x00, 0xff, 0x17});
+        frames.push_back(i % 2 == 0 ? nasa_frame(150 + i % 200) : non_nasa_frame(0x00, 0xc8, i & 0xff));
+        stream.insert(stream.end(), frames.back().begin(), frames.back().end());
+    }
+
+    FeedUART uart;
+    uart::UARTDevice device(&uart);
+    RxTask task;
+    assert(task.start(&device));
+    assert(task.is_running());
+
+    std::thread feeder([&]()
+                       {
+        std::mt19937 random(1);
+        for (size_t i = 0; i < stream.size();)
+        {
+            const size_t length = std::min<size_t>(1 + random() % 40, stream.size() - i);
+            uart.feed(std::vector<uint8_t>(stream.begin() + i, stream.begin() + i + length));
+            i += length;
+            if (random() % 8 == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+        } });
+
+    size_t received = 0, discarded = 0;
+    uint32_t time, last_time = 0;
+    CaptureDirection direction;
+    std::vector<uint8_t> data;
+    const uint32_t start = millis();
+    while (received < frames.size() && millis() - start < 10000)
+    {
+        if (!task.pop(time, direction, data))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        assert((int32_t)(time - last_time) >= 0);
+        last_time = time;
+        if (direction == CaptureDirection::Discarded)
+        {
+            assert(data == std::vector<uint8_t>({0x00, 0xff, 0x17}));
+            discarded++;
+            continue;
+        }
+        assert(direction == CaptureDirection::Received);
+        assert(data == frames[received]);
+        received++;
+    }
+    feeder.join();
+    task.stop();
+
+    assert(!task.is_running());
+    assert(received == frames.size());
+    assert(discarded == 30);
+    assert(task.dropped() == 0);
+    assert(task.last_activity() != 0 && !task.receiving());
+}
+
+void test_rx_task_overflow()
+{
+    cout << "test_rx_task_overflow" << endl;
+
+    FeedUART uart;
+    uart::UARTDevice device(&uart);
+    RxTask task;
+
+    // nobody takes the frames, the ring fills up and later frames are dropped
+    const auto frame = nasa_frame(200);
+    for (int i = 0; i < 500; i++)
+        uart.feed(frame);
+    task.poll(&device, 1000);
+
+    const size_t fitting = rxRingSize / (captureRecordHeaderSize + frame.size());
+    assert(task.dropped() == 500 - fitting);
+
+    uint32_t time;
+    CaptureDirection direction;
+    std::vector<uint8_t> data;
+    size_t count = 0;
+    while (task.pop(time, direction, data))
+    {
+        assert(time == 1000 && data == frame);
+        count++;
+    }
+    assert(count == fitting);
+
+    // an incomplete frame is discarded once the bus is silent
+    uart.feed(std::vector<uint8_t>(frame.begin(), frame.begin() + 10));
+    task.poll(&device, 2000);
+    assert(task.receiving() && !task.pop(time, direction, data));
+    task.poll(&device, 2000 + rxFrameTimeout);
+    assert(!task.receiving());
+    assert(task.pop(time, direction, data) && direction == CaptureDirection::Discarded && data.size() == 10);
+}
+
+int main(int argc, char *argv[])
+{
+    test_frame_length();
+    test_spsc_ring();
+    test_rx_task();
+    test_rx_task_overflow();
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include "series_store.h"
+#include "../components/samsung_ac/device_registry.h"
+
+using namespace std;
+
+const char *seriesPath = "test_series.sacs";
+
+void test_varint()
+{
+    cout << "test_varint" << endl;
+
+    std::vector<uint8_t> out;
+    for (int64_t value : {0ll, 1ll, -1ll, 63ll, -64ll, 300ll, -70000ll, 0x7fffffffffffffffll})
+        put_varint(out, zigzag(value));
+    assert(zigzag(-1) == 1 && zigzag(1) == 2);
+
+    const uint8_t *cursor = out.data();
+    for (int64_t value : {0ll, 1ll, -1ll, 63ll, -64ll, 300ll, -70000ll, 0x7fffffffffffffffll})
+        assert(unzigzag(get_varint(cursor)) == value);
+    assert(cursor == out.data() + out.size());
+}
+
+void test_series_type()
+{
+    cout << "test_series_type" << endl;
+
+    assert(series_type((uint16_t)MessageNumber::ENUM_in_operation_power) == Enum);
+    assert(series_type((uint16_t)MessageNumber::VAR_in_temp_room_f) == Variable);
+    assert(series_type((uint16_t)MessageNumber::LVAR_OUT_CONTROL_WATTMETER_ALL_UNIT_ACCUM) == LongVariable);
+}
+
+void test_store()
+{
+    cout << "test_store" << endl;
+
+    const uint32_t indoor = pack_address("20.00.00");
+    const uint32_t outdoor = pack_address("10.00.00");
+    const uint16_t power = (uint16_t)MessageNumber::ENUM_in_operation_power;
+    const uint16_t room = (uint16_t)MessageNumber::VAR_in_temp_room_f;
+    const uint16_t energy = (uint16_t)MessageNumber::LVAR_OUT_CONTROL_WATTMETER_ALL_UNIT_ACCUM;
+    const size_t points = 3 * seriesBlockSize + 10;
+
+    SeriesWriter writer;
+    for (uint32_t i = 0; i < points; i++)
+    {
+        uint32_t time = 1000 + i * 500;
+        writer.add(indoor, power, time, (i / 100) % 2);
+        writer.add(indoor, room, time, 215 + (int)(i % 7) - 3);
+        writer.add(outdoor, energy, time, 123456789 + i * 3);
+    }
+    // a restart of the device, the time starts over
+    writer.add(indoor, room, 10, 200);
+    assert(writer.write(seriesPath));
+
+    SeriesReader reader;
+    assert(reader.open(seriesPath));
+    assert(reader.series().size() == 3);
+    assert(reader.find(indoor, power) != nullptr);
+    assert(reader.find(indoor, power)->type == Enum);
+    assert(reader.find(indoor, power)->blocks.size() == 4);
+    assert(reader.find(indoor, room)->blocks.size() == 5);
+    assert(reader.find(outdoor, power) == nullptr);
+
+    // everything
+    size_t i = 0;
+    size_t found = reader.query(indoor, power, 0, 0xFFFFFFFF, [&i](uint32_t time, int64_t value)
+                                {
+        assert(time == 1000 + i * 500);
+        assert(value == (int64_t)((i / 100) % 2));
+        i++; });
+    assert(found == points);
+
+    // a range across a block boundary
+    uint32_t from = 1000 + (seriesBlockSize - 5) * 500;
+    uint32_t to = 1000 + (seriesBlockSize + 5) * 500;
+    i = seriesBlockSize - 5;
+    found = reader.query(outdoor, energy, from, to, [&i](uint32_t time, int64_t value)
+                         {
+        assert(time == 1000 + i * 500);
+        assert(value == 123456789 + (int64_t)i * 3);
+        i++; });
+    assert(found == 11);
+
+    std::vector<int64_t> values;
+    found = reader.query(indoor, room, 0, 999, [&values](uint32_t time, int64_t value)
+                         { values.push_back(value); });
+    assert(found == 1);
+    assert(values[0] == 200);
+
+    found = reader.query(indoor, room, 1000, 1000, [&values](uint32_t time, int64_t value)
+                         { values.push_back(value); });
+    assert(found == 1);
+    assert(values[1] == 212);
+
+    assert(reader.query(indoor, room, 0xFFFFFF00, 0xFFFFFFFF, [](uint32_t, int64_t) {}) == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    test_varint();
+    test_series_type();
+    test_store();
+    remove(seriesPath);
+    return 0;
+}
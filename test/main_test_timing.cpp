@@ -0,0 +1,307 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include "virtual_target.h"
+#include "../components/samsung_ac/protocol_nasa.h"
+#include "../components/samsung_ac/protocol_non_nasa.h"
+
+using namespace std;
+
+const uint8_t registerCommand = 0xD1;
+const uint8_t controlCommand = 0xB0;
+
+std::vector<uint8_t> non_nasa_frame(uint8_t src, uint8_t dst, uint8_t cmd, uint8_t data4 = 0)
+{
+    NonNasaFrame frame(src, dst, cmd);
+    frame.set(4, data4);
+    return frame.to_vector();
+}
+
+std::vector<uint8_t> request_control()
+{
+    return non_nasa_frame(0xc8, 0xd0, 0xc6, 1);
+}
+
+std::vector<uint8_t> nasa_frame(const std::string &source, DataType type, uint8_t packet_number, const std::string &dest = "b0.ff.20", int power = 0)
+{
+    Packet packet = Packet::create(Address::parse(dest), type, MessageNumber::ENUM_in_operation_power, power);
+    packet.sa = Address::parse(source);
+    packet.command.packetNumber = packet_number;
+    return packet.encode();
+}
+
+void test_non_nasa_register_interval(VirtualTarget &target)
+{
+    cout << "test_non_nasa_register_interval" << endl;
+
+    protocol_processing = ProtocolProcessing::NonNASA;
+    controller_registered = false;
+    Protocol *protocol = get_protocol("00");
+
+    const uint32_t start = target.clock().now();
+    target.clock().run(60000, 100, [&]()
+                       { protocol->protocol_update(&target); });
+
+    // at most one registration per NONNASA_REGISTER_INTERVAL_MS (5 s)
+    assert(target.count_sent(registerCommand, start) == 11);
+    uint32_t last = 0;
+    for (const auto &frame : target.sent)
+    {
+        if (frame.time < start || frame.data[3] != registerCommand)
+            continue;
+        assert(last == 0 || frame.time - last > 5000);
+        last = frame.time;
+    }
+}
+
+void test_non_nasa_resend(VirtualTarget &target)
+{
+    cout << "test_non_nasa_resend" << endl;
+
+    protocol_processing = ProtocolProcessing::NonNASA;
+    controller_registered = true;
+    indoor_unit_awake = true;
+    Protocol *protocol = get_protocol("00");
+    const uint32_t start = target.clock().now();
+
+    ProtocolRequest request;
+    request.power = true;
+    request.target_temp = 22;
+    protocol->publish_request(&target, "00", request);
+    assert(target.count_sent(controlCommand, start) == 0);
+
+    // sent in the next request_control window
+    target.clock().advance(500);
+    assert(target.receive(request_control()) == 1);
+    assert(target.count_sent(controlCommand, start) == 1);
+
+    // no ack within 4.5 s, sent again in the next window
+    target.clock().run(4500, 100, [&]()
+                       { protocol->protocol_update(&target); });
+    assert(target.receive(request_control()) == 1);
+    assert(target.count_sent(controlCommand, start) == 1);
+
+    target.clock().run(200, 100, [&]()
+                       { protocol->protocol_update(&target); });
+    assert(target.receive(request_control()) == 1);
+    assert(target.count_sent(controlCommand, start) == 2);
+
+    // acked, nothing left to send
+    assert(target.receive(non_nasa_frame(0x00, 0xd0, 0x54)) == 1);
+    target.clock().advance(1000);
+    assert(target.receive(request_control()) == 1);
+    assert(target.count_sent(controlCommand, start) == 2);
+}
+
+void test_non_nasa_request_timeout(VirtualTarget &target)
+{
+    cout << "test_non_nasa_request_timeout" << endl;
+
+    protocol_processing = ProtocolProcessing::NonNASA;
+    controller_registered = true;
+    indoor_unit_awake = true;
+    Protocol *protocol = get_protocol("00");
+    const uint32_t start = target.clock().now();
+
+    ProtocolRequest request;
+    request.power = false;
+    protocol->publish_request(&target, "00", request);
+
+    // not sent within 1 s, the units are woken up with a registration
+    target.clock().run(1100, 100, [&]()
+                       { protocol->protocol_update(&target); });
+    assert(!indoor_unit_awake);
+    assert(target.count_sent(registerCommand, start) == 1);
+
+    // dropped after 15 s
+    target.clock().run(14000, 100, [&]()
+                       { protocol->protocol_update(&target); });
+    indoor_unit_awake = true;
+    assert(target.receive(request_control()) == 1);
+    assert(target.count_sent(controlCommand, start) == 0);
+}
+
+void test_nasa_ack(VirtualTarget &target)
+{
+    cout << "test_nasa_ack" << endl;
+
+    protocol_processing = ProtocolProcessing::NASA;
+    Protocol *protocol = get_protocol("20.00.00");
+    const size_t sent = target.sent.size();
+
+    ProtocolRequest request;
+    request.power = true;
+    protocol->publish_request(&target, "20.00.00", request);
+    assert(target.sent.size() == sent + 1);
+
+    Packet packet;
+    assert(packet.decode(target.sent.back().data).type == DecodeResultType::Processed);
+
+    target.clock().advance(300);
+    assert(target.receive(nasa_frame("20.00.00", DataType::Ack, packet.command.packetNumber, "80.ff.00")) == 1);
+
+    // no resends for an acked packet
+    target.clock().run(5000, 100, [&]()
+                       { target.receive(nasa_frame("10.00.00", DataType::Notification, 1)); });
+    assert(target.sent.size() == sent + 1);
+}
+
+// a wired remote (50.00.00) uses the same packet number as we do
+void test_nasa_foreign_ack(VirtualTarget &target)
+{
+    cout << "test_nasa_foreign_ack" << endl;
+
+    protocol_processing = ProtocolProcessing::NASA;
+    Protocol *protocol = get_protocol("20.00.00");
+    const size_t sent = target.sent.size();
+
+    ProtocolRequest request;
+    request.power = true;
+    protocol->publish_request(&target, "20.00.00", request);
+    Packet packet;
+    assert(packet.decode(target.sent.back().data).type == DecodeResultType::Processed);
+    const uint8_t number = packet.command.packetNumber;
+
+    target.receive(nasa_frame("50.00.00", DataType::Request, number, "20.00.00", 1));
+    target.updates.clear();
+
+    // the ack to us confirms our packet, not the request of the remote
+    target.clock().advance(200);
+    assert(target.receive(nasa_frame("20.00.00", DataType::Ack, number, "80.ff.00")) == 1);
+    assert(target.updates["20.00.00"] == 0);
+
+    // the ack to the remote applies its values
+    assert(target.receive(nasa_frame("20.00.00", DataType::Ack, number, "50.00.00")) == 1);
+    assert(target.updates["20.00.00"] > 0);
+
+    // no resends for our acked packet
+    target.clock().run(5000, 100, [&]()
+                       { target.receive(nasa_frame("10.00.00", DataType::Notification, 1)); });
+    assert(target.sent.size() == sent + 1);
+}
+
+void test_nasa_resend(VirtualTarget &target)
+{
+    cout << "test_nasa_resend" << endl;
+
+    protocol_processing = ProtocolProcessing::NASA;
+    Protocol *protocol = get_protocol("20.00.00");
+    const size_t sent = target.sent.size();
+    const uint32_t start = target.clock().now();
+
+    ProtocolRequest request;
+    request.target_temp = 23;
+    protocol->publish_request(&target, "20.00.00", request);
+
+    // resent after more than 1 s, with every notification on the bus, at most 3 times
+    target.clock().run(10000, 100, [&]()
+                       { target.receive(nasa_frame("10.00.00", DataType::Notification, 1)); });
+    assert(target.sent.size() == sent + 4);
+    assert(target.sent[sent].time == start);
+    assert(target.sent[sent + 1].time == start + 1100);
+    assert(target.sent[sent + 2].time == start + 2200);
+    assert(target.sent[sent + 3].time == start + 3300);
+}
+
+// a broadcast has no addresses and is not acked by any single unit
+void test_nasa_broadcast(VirtualTarget &target)
+{
+    cout << "test_nasa_broadcast" << endl;
+
+    protocol_processing = ProtocolProcessing::NASA;
+    const size_t sent = target.sent.size();
+
+    ProtocolRequest request;
+    request.power = false;
+    nasaProtocol->publish_group_request(&target, {}, request, true);
+    assert(target.sent.size() == sent + 1);
+
+    Packet packet;
+    assert(packet.decode(target.sent.back().data).type == DecodeResultType::Processed);
+    assert(packet.da.klass == AddressClass::BroadcastControlLayer);
+    assert(packet.command.dataType == DataType::Request);
+
+    target.clock().run(5000, 100, [&]()
+                       { target.receive(nasa_frame("10.00.00", DataType::Notification, 1)); });
+    assert(target.sent.size() == sent + 1);
+}
+
+void test_nasa_poll_budget(VirtualTarget &target)
+{
+    cout << "test_nasa_poll_budget" << endl;
+
+    protocol_processing = ProtocolProcessing::NASA;
+    Protocol *protocol = get_protocol("20.00.00");
+    const size_t sent = target.sent.size();
+
+    // a read request and its response take about 46 ms, 1% of the bus allows one every 4.6 s
+    nasa_poll_bus_utilisation = 0.01f;
+    protocol->add_poll_message("20.00.00", (uint16_t)MessageNumber::VAR_in_temp_room_f, 1000);
+    target.clock().run(60000, 100, [&]()
+                       { protocol->protocol_update(&target); });
+
+    // 13 from the budget plus the capped credit saved up before
+    assert(target.sent.size() - sent >= 13 && target.sent.size() - sent <= 17);
+
+    // waiting for credit does not use up packet numbers
+    for (size_t i = sent + 1; i < target.sent.size(); i++)
+    {
+        Packet previous, packet;
+        assert(previous.decode(target.sent[i - 1].data).type == DecodeResultType::Processed);
+        assert(packet.decode(target.sent[i].data).type == DecodeResultType::Processed);
+        assert(packet.command.dataType == DataType::Read);
+        assert(packet.command.packetNumber == (uint8_t)(previous.command.packetNumber + 1));
+    }
+    nasa_poll_bus_utilisation = 0.1f;
+}
+
+// a NonNASA system for hours: status every second, request_control every second and the
+// protocol update of the main loop every 200 ms
+void benchmark_non_nasa(VirtualTarget &target)
+{
+    protocol_processing = ProtocolProcessing::NonNASA;
+    controller_registered = true;
+    indoor_unit_awake = true;
+    Protocol *protocol = get_protocol("00");
+
+    const uint32_t hours = 6;
+    const auto status = non_nasa_frame(0x00, 0xc8, 0x20, 0x4d);
+    const auto control = request_control();
+    uint32_t tick = 0;
+    size_t frames = 0;
+
+    auto start = chrono::steady_clock::now();
+    target.clock().run(hours * 3600 * 1000, 200, [&]()
+                       {
+        tick++;
+        if (tick % 5 == 0)
+            frames += target.receive(status);
+        if (tick % 5 == 2)
+            frames += target.receive(control);
+        if (tick % 1500 == 0)
+        {
+            ProtocolRequest request;
+            request.power = (tick / 1500) % 2;
+            protocol->publish_request(&target, "00", request);
+        }
+        protocol->protocol_update(&target); });
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "benchmark_non_nasa: " << hours << " h of bus time (" << frames << " frames) in " << ms << " ms" << endl;
+    assert(frames == hours * 3600 * 2);
+}
+
+int main(int argc, char *argv[])
+{
+    VirtualTarget target;
+    test_non_nasa_register_interval(target);
+    test_non_nasa_resend(target);
+    test_non_nasa_request_timeout(target);
+    test_nasa_ack(target);
+    test_nasa_foreign_ack(target);
+    test_nasa_resend(target);
+    test_nasa_broadcast(target);
+    test_nasa_poll_budget(target);
+    benchmark_non_nasa(target);
+    return 0;
+}
@@ -0,0 +1,2 @@
+g++ -O2 test/main_query_series.cpp components/samsung_ac/util.cpp -Itest -o query_series
+./query_series "$@"
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstring>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include "../components/samsung_ac/capture.h"
+
+using namespace esphome::samsung_ac;
+
+// writes the raw stream of the component to a capture file, checking every record on the way
+class CaptureReceiver
+{
+public:
+    explicit CaptureReceiver(std::ostream &out) : out_(out) {}
+
+    // returns false if the stream is not a capture stream
+    bool feed(const uint8_t *data, size_t size)
+    {
+        pending_.insert(pending_.end(), data, data + size);
+
+        size_t offset = 0;
+        if (!header_received_)
+        {
+            if (pending_.size() < captureHeaderSize)
+                return true;
+            if (!is_capture_header(pending_.data(), pending_.size()))
+                return false;
+            out_.write((const char *)pending_.data(), captureHeaderSize);
+            header_received_ = true;
+            offset = captureHeaderSize;
+        }
+
+        CaptureRecord record;
+        while (size_t length = parse_capture_record(pending_.data() + offset, pending_.size() - offset, record))
+        {
+            if (record.direction == CaptureDirection::Dropped && record.length == 4)
+                dropped = record.data[0] | record.data[1] << 8 | record.data[2] << 16 | (uint32_t)record.data[3] << 24;
+            else
+                frames++;
+
+            out_.write((const char *)pending_.data() + offset, length);
+            offset += length;
+        }
+
+        pending_.erase(pending_.begin(), pending_.begin() + offset);
+        return true;
+    }
+
+    // bytes of a record which was cut off by the end of the stream
+    size_t incomplete() const
+    {
+        return pending_.size();
+    }
+
+    uint64_t frames = 0;
+    uint32_t dropped = 0;
+
+protected:
+    std::ostream &out_;
+    std::vector<uint8_t> pending_;
+    bool header_received_ = false;
+};
+
+inline int connect_tcp(const std::string &host, const std::string &port)
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *result;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0)
+        return -1;
+
+    int fd = -1;
+    for (struct addrinfo *info = result; info != nullptr; info = info->ai_next)
+    {
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd < 0)
+            continue;
+        if (connect(fd, info->ai_addr, info->ai_addrlen) == 0)
+            break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    return fd;
+}
+
+// reads until the connection is closed, returns false if the stream was invalid
+inline bool receive_stream(int fd, CaptureReceiver &receiver)
+{
+    uint8_t buffer[4096];
+    while (true)
+    {
+        ssize_t received = read(fd, buffer, sizeof(buffer));
+        if (received <= 0)
+            return true;
+        if (!receiver.feed(buffer, received))
+            return false;
+    }
+}
@@ -0,0 +1,2 @@
+g++ test/main_raw_stream_receiver.cpp -Itest -o raw_stream_receiver
+./raw_stream_receiver "$@"
\ No newline at end of file
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include "capture_file.h"
+#include "../components/samsung_ac/protocol_nasa.h"
+
+using namespace esphome::samsung_ac;
+
+// Columnar store of decoded NASA values, one series per (source address, message number).
+//
+// file: "SACS" version(u8) blocks... directory trailer
+// directory entry: source(u32) message(u16) type(u8) block count(u32) blocks[block count]
+// block entry: first time(u32) last time(u32) count(u32) offset(u64) size(u32)
+// trailer: directory offset(u64) series count(u32) "SACS"
+//
+// A block holds up to seriesBlockSize points. Times are stored as varint deltas. Enum values
+// are run-length encoded as (value, run) pairs, variables as zigzag varint deltas. The type of a
+// series comes from its message number, exactly as MessageSet derives it when decoding.
+// The directory is sorted by source and message, all numbers are little endian.
+
+const uint8_t seriesVersion = 1;
+const size_t seriesBlockSize = 1024;
+
+inline MessageSetType series_type(uint16_t message)
+{
+    return MessageSet((MessageNumber)message).type;
+}
+
+inline void put_varint(std::vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((uint8_t)value | 0x80);
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+inline uint64_t get_varint(const uint8_t *&data)
+{
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        uint8_t byte = *data++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+}
+
+inline uint64_t zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+struct SeriesBlock
+{
+    uint32_t first_time;
+    uint32_t last_time;
+    uint32_t count;
+    uint64_t offset;
+    uint32_t size;
+};
+
+struct SeriesKey
+{
+    uint32_t source;
+    uint16_t message;
+
+    bool operator<(const SeriesKey &other) const
+    {
+        return source != other.source ? source < other.source : message < other.message;
+    }
+};
+
+// Collects points in memory (encoded, so a week of traffic stays small) and writes the store.
+class SeriesWriter
+{
+public:
+    // points of a series have to be added in time order, a step back (e.g. a device restart in
+    // a long capture) starts a new block
+    void add(uint32_t source, uint16_t message, uint32_t time, int64_t value)
+    {
+        Series &series = series_[SeriesKey{source, message}];
+        if (series.points > 0 && (series.points == seriesBlockSize || time < series.last_time))
+            flush(series);
+
+        if (series.points == 0)
+        {
+            series.first_time = time;
+            series.last_time = time;
+            series.times.clear();
+            series.values.clear();
+            series.run_value = value;
+            series.run = 0;
+            series.last_value = 0;
+        }
+
+        put_varint(series.times, time - series.last_time);
+        series.last_time = time;
+
+        if (series_type(message) == Enum)
+        {
+            if (series.run > 0 && value != series.run_value)
+            {
+                put_varint(series.values, zigzag(series.run_value));
+                put_varint(series.values, series.run);
+                series.run = 0;
+            }
+            series.run_value = value;
+            series.run++;
+        }
+        else
+        {
+            put_varint(series.values, zigzag(value - series.last_value));
+            series.last_value = value;
+        }
+        series.points++;
+    }
+
+    bool write(const std::string &path)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        std::vector<uint8_t> out = {'S', 'A', 'C', 'S', seriesVersion};
+        file.write((const char *)out.data(), out.size());
+        uint64_t offset = out.size();
+
+        for (auto &entry : series_)
+        {
+            Series &series = entry.second;
+            if (series.points > 0)
+                flush(series);
+            for (size_t i = 0; i < series.blocks.size(); i++)
+            {
+                series.blocks[i].offset = offset;
+                file.write((const char *)series.data[i].data(), series.data[i].size());
+                offset += series.data[i].size();
+            }
+        }
+
+        out.clear();
+        for (const auto &entry : series_)
+        {
+            append_capture_le(out, entry.first.source, 4);
+            append_capture_le(out, entry.first.message, 2);
+            out.push_back(series_type(entry.first.message));
+            append_capture_le(out, entry.second.blocks.size(), 4);
+            for (const auto &block : entry.second.blocks)
+            {
+                append_capture_le(out, block.first_time, 4);
+                append_capture_le(out, block.last_time, 4);
+                append_capture_le(out, block.count, 4);
+                append_capture_le(out, block.offset, 8);
+                append_capture_le(out, block.size, 4);
+            }
+        }
+        append_capture_le(out, offset, 8);
+        append_capture_le(out, series_.size(), 4);
+        out.insert(out.end(), {'S', 'A', 'C', 'S'});
+        file.write((const char *)out.data(), out.size());
+        file.close();
+        return !file.fail();
+    }
+
+protected:
+    struct Series
+    {
+        std::vector<SeriesBlock> blocks;
+        std::vector<std::vector<uint8_t>> data;
+
+        // block being filled
+        uint32_t points = 0;
+        uint32_t first_time = 0;
+        uint32_t last_time = 0;
+        std::vector<uint8_t> times;
+        std::vector<uint8_t> values;
+        int64_t last_value = 0;
+        int64_t run_value = 0;
+        uint32_t run = 0;
+    };
+
+    void flush(Series &series)
+    {
+        if (series.run > 0)
+        {
+            put_varint(series.values, zigzag(series.run_value));
+            put_varint(series.values, series.run);
+            series.run = 0;
+        }
+
+        std::vector<uint8_t> data = std::move(series.times);
+        data.insert(data.end(), series.values.begin(), series.values.end());
+        series.blocks.push_back(SeriesBlock{series.first_time, series.last_time, series.points, 0, (uint32_t)data.size()});
+        series.data.push_back(std::move(data));
+        series.times = std::vector<uint8_t>();
+        series.points = 0;
+    }
+
+    std::map<SeriesKey, Series> series_;
+};
+
+// Mapped series store. Range queries only decode the blocks which overlap the range.
+class SeriesReader
+{
+public:
+    struct SeriesInfo
+    {
+        uint32_t source;
+        uint16_t message;
+        MessageSetType type;
+        std::vector<SeriesBlock> blocks;
+    };
+
+    bool open(const std::string &path)
+    {
+        series_.clear();
+        if (!file_.open(path))
+            return false;
+
+        const uint8_t *data = file_.data();
+        size_t size = file_.size();
+        if (size < 5 + 16 || data[0] != 'S' || data[1] != 'A' || data[2] != 'C' || data[3] != 'S' || data[4] != seriesVersion)
+            return false;
+
+        const uint8_t *trailer = data + size - 16;
+        if (trailer[12] != 'S' || trailer[13] != 'A' || trailer[14] != 'C' || trailer[15] != 'S')
+            return false;
+
+        uint64_t directory = read_capture_le(trailer, 8);
+        uint32_t count = read_capture_le(trailer + 8, 4);
+        if (directory > size - 16)
+            return false;
+
+        const uint8_t *cursor = data + directory;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            SeriesInfo info;
+            info.source = read_capture_le(cursor, 4);
+            info.message = read_capture_le(cursor + 4, 2);
+            info.type = (MessageSetType)cursor[6];
+            uint32_t blocks = read_capture_le(cursor + 7, 4);
+            cursor += 11;
+            for (uint32_t b = 0; b < blocks; b++)
+            {
+                info.blocks.push_back(SeriesBlock{(uint32_t)read_capture_le(cursor, 4), (uint32_t)read_capture_le(cursor + 4, 4),
+                                                  (uint32_t)read_capture_le(cursor + 8, 4), read_capture_le(cursor + 12, 8),
+                                                  (uint32_t)read_capture_le(cursor + 20, 4)});
+                cursor += 24;
+            }
+            series_.push_back(std::move(info));
+        }
+        return true;
+    }
+
+    const std::vector<SeriesInfo> &series() const
+    {
+        return series_;
+    }
+
+    const SeriesInfo *find(uint32_t source, uint16_t message) const
+    {
+        auto it = std::lower_bound(series_.begin(), series_.end(), SeriesKey{source, message}, [](const SeriesInfo &info, const SeriesKey &key)
+                                   { return SeriesKey{info.source, info.message} < key; });
+        if (it != series_.end() && it->source == source && it->message == message)
+            return &*it;
+        return nullptr;
+    }
+
+    // calls f(time, value) for all points with from <= time <= to, returns the number of points
+    template <typename F>
+    size_t query(uint32_t source, uint16_t message, uint32_t from, uint32_t to, F f) const
+    {
+        const SeriesInfo *info = find(source, message);
+        if (info == nullptr)
+            return 0;
+
+        size_t found = 0;
+        std::vector<uint32_t> times;
+        for (const auto &block : info->blocks)
+        {
+            if (block.last_time < from || block.first_time > to)
+                continue;
+
+            const uint8_t *cursor = file_.data() + block.offset;
+            times.resize(block.count);
+            uint32_t time = block.first_time;
+            for (uint32_t i = 0; i < block.count; i++)
+            {
+                time += get_varint(cursor);
+                times[i] = time;
+            }
+
+            uint32_t i = 0;
+            int64_t value = 0;
+            while (i < block.count)
+            {
+                uint32_t run = 1;
+                if (info->type == Enum)
+                {
+                    value = unzigzag(get_varint(cursor));
+                    run = get_varint(cursor);
+                }
+                else
+                    value += unzigzag(get_varint(cursor));
+
+                for (uint32_t end = std::min(block.count, i + run); i < end; i++)
+                {
+                    if (times[i] >= from && times[i] <= to)
+                    {
+                        f(times[i], value);
+                        found++;
+                    }
+                }
+            }
+        }
+        return found;
+    }
+
+protected:
+    MappedFile file_;
+    std::vector<SeriesInfo> series_;
+};
@@ -1,3 +1,13 @@
 @call "%~dp0%test_nasa.cmd"
 
 @call "%~dp0%test_non_nasa.cmd"
+
+@call "%~dp0%test_registry.cmd"
+
+@call "%~dp0%test_capture.cmd"
+
+@call "%~dp0%test_decoder.cmd"
+
+@call "%~dp0%test_series.cmd"
+
+@call "%~dp0%test_timing.cmd"
\ No newline at end of file
@@ -1,3 +1,13 @@
 #/bin/sh
 ./test/test_nasa.sh
-./test/test_non_nasa.sh
\ No newline at end of file
+./test/test_non_nasa.sh
+./test/test_registry.sh
+./test/test_raw_stream.sh
+./test/test_capture.sh
+./test/test_decoder.sh
+./test/test_series.sh
+./test/test_timing.sh
+./test/test_host.sh
+./test/test_rx_task.sh
+./test/load_test.sh
+./test/build_tools.sh
\ No newline at end of file
@@ -0,0 +1,4 @@
+@echo ""
+@echo ==== TESTING Capture ====
+@g++ test/main_test_capture.cpp -Itest -o test.exe
+@test.exe
\ No newline at end of file
@@ -0,0 +1,4 @@
+@echo ""
+@echo ==== TESTING Decoder ====
+@g++ test/main_test_decoder.cpp -Itest -pthread -o test.exe
+@test.exe
\ No newline at end of file
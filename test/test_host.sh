@@ -0,0 +1,3 @@
+echo ==== TESTING Host platform ====
+g++ test/main_test_host.cpp -Itest -o test.exe
+./test.exe
\ No newline at end of file
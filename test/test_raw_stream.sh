@@ -0,0 +1,3 @@
+echo ==== TESTING Raw stream ====
+g++ test/main_test_raw_stream.cpp -Itest -pthread -o test.exe
+./test.exe
\ No newline at end of file
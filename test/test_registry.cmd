@@ -0,0 +1,3 @@
+@echo ""
+@echo ==== TESTING Registry ====
+@"%~dp0%build_and_run.cmd" test/main_test_registry.cpp
\ No newline at end of file
@@ -0,0 +1,3 @@
+echo ==== TESTING Registry ====
+g++ test/main_test_registry.cpp -Itest -o test.exe
+./test.exe
\ No newline at end of file
@@ -0,0 +1,4 @@
+echo ==== TESTING RX task ====
+# the task and the main loop run on separate threads, ThreadSanitizer reports any data race
+g++ -g -O1 -fsanitize=thread test/main_test_rx_task.cpp components/samsung_ac/rx_task.cpp components/samsung_ac/protocol.cpp components/samsung_ac/protocol_nasa.cpp components/samsung_ac/protocol_non_nasa.cpp components/samsung_ac/util.cpp components/samsung_ac/debug_mqtt.cpp -Itest -pthread -o test.exe
+./test.exe
\ No newline at end of file
@@ -0,0 +1,4 @@
+@echo ""
+@echo ==== TESTING Series ====
+@g++ test/main_test_series.cpp -Itest -o test.exe
+@test.exe
\ No newline at end of file
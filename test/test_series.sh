@@ -0,0 +1,3 @@
+echo ==== TESTING Series ====
+g++ test/main_test_series.cpp -Itest -o test.exe
+./test.exe
\ No newline at end of file
@@ -3,10 +3,11 @@
 #include <bitset>
 #include <cassert>
 #include <optional>
+#include <set>
 #include "esphome/core/optional.h"
 
 #include "../components/samsung_ac/util.h"
-#include "../components/samsung_ac/protocol.h"
+#include "../components/samsung_ac/device_registry.h"
 
 using namespace std;
 using namespace esphome::samsung_ac;
@@ -14,197 +15,203 @@ using namespace esphome::samsung_ac;
 class DebugTarget : public MessageTarget
 {
 public:
-    uint32_t get_miliseconds()
+    uint32_t miliseconds = 0;
+    uint32_t get_miliseconds() override
     {
-        return 0;
+        return miliseconds;
     }
 
     std::string last_publish_data;
-    void publish_data(std::vector<uint8_t> &data)
+    void publish_data(uint8_t id, std::vector<uint8_t> &&data) override
     {
         last_publish_data = bytes_to_hex(data);
         cout << "> publish_data " << last_publish_data << endl;
     }
 
+    void ack_data(uint8_t id) override {}
+
     std::string last_register_address;
-    void register_address(const std::string address)
+    void register_address(PackedAddress packed) override
     {
+        const std::string address = unpack_address(packed);
         cout << "> register_address " << address << endl;
         last_register_address = address;
     }
 
     std::string last_set_power_address;
     bool last_set_power_value;
-    void set_power(const std::string address, bool value)
+    void set_power(PackedAddress packed, bool value) override
     {
+        const std::string address = unpack_address(packed);
         cout << "> " << address << " set_power=" << to_string(value) << endl;
         last_set_power_address = address;
         last_set_power_value = value;
     }
 
+    void set_automatic_cleaning(PackedAddress packed, bool value) override {}
+    void set_water_heater_power(PackedAddress packed, bool value) override {}
+
     std::string last_set_room_temperature_address;
     float last_set_room_temperature_value;
-    void set_room_temperature(const std::string address, float value)
+    void set_room_temperature(PackedAddress packed, Temperature value) override
     {
-        cout << "> " << address << " set_room_temperature=" << to_string(value) << endl;
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_room_temperature=" << to_string(value.to_float()) << endl;
         last_set_room_temperature_address = address;
-        last_set_room_temperature_value = value;
-    }
-
-    std::string last_set_water_temperature_address;
-    float last_set_water_temperature_value;
-    void set_water_temperature(const std::string address, float value)
-    {
-        cout << "> " << address << " set_water_temperature=" << to_string(value) << endl;
-        last_set_water_temperature_address = address;
-        last_set_water_temperature_value = value;
+        last_set_room_temperature_value = value.to_float();
     }
 
     std::string last_set_target_temperature_address;
     float last_set_target_temperature_value;
-    void set_target_temperature(const std::string address, float value)
+    void set_target_temperature(PackedAddress packed, Temperature value) override
     {
-        cout << "> " << address << " set_target_temperature=" << to_string(value) << endl;
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_target_temperature=" << to_string(value.to_float()) << endl;
         last_set_target_temperature_address = address;
-        last_set_target_temperature_value = value;
+        last_set_target_temperature_value = value.to_float();
     }
 
+    void set_water_outlet_target(PackedAddress packed, Temperature value) override {}
+
     std::string last_set_outdoor_temperature_address;
     float last_set_outdoor_temperature_value;
-    void set_outdoor_temperature(const std::string address, float value)
+    void set_outdoor_temperature(PackedAddress packed, Temperature value) override
     {
-        cout << "> " << address << " set_outdoor_temperature=" << to_string(value) << endl;
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_outdoor_temperature=" << to_string(value.to_float()) << endl;
         last_set_outdoor_temperature_address = address;
-        last_set_outdoor_temperature_value = value;
-
-        std::string last_set_target_water_temperature_address;
-        float last_set_target_water_temperature_value;
-        void set_target_water_temperature(const std::string address, float value)
-        {
-            cout << "> " << address << " set_target_water_temperature=" << to_string(value) << endl;
-            last_set_target_water_temperature_address = address;
-            last_set_target_water_temperature_value = value;
-        }
-
-        std::string last_set_room_humidity_address;
-        float last_set_room_humidity_value;
-        void set_room_humidity(const std::string address, float value)
-        {
-            cout << "> " << address << " set_room_humidity=" << to_string(value) << endl;
-            last_set_room_humidity_address = address;
-            last_set_room_humidity_value = value;
-        }
-
-        std::string last_set_mode_address;
-        Mode last_set_mode_mode;
-        void set_mode(const std::string address, Mode mode)
-        {
-            cout << "> " << address << " set_mode=" << to_string((int)mode) << endl;
-            last_set_mode_address = address;
-            last_set_mode_mode = mode;
-        }
-
-        std::string last_set_fanmode_address;
-        FanMode last_set_fanmode_mode;
-        void set_fanmode(const std::string address, FanMode fanmode)
-        {
-            cout << "> " << address << " set_fanmode=" << to_string((int)fanmode) << endl;
-            last_set_fanmode_address = address;
-            last_set_fanmode_mode = fanmode;
-        }
-
-        void set_altmode(const std::string address, AltMode altmode)
-        {
-            cout << "> " << address << " set_altmode=" << to_string((int)altmode) << endl;
-        }
-
-        void set_swing_vertical(const std::string address, bool vertical)
-        {
-            cout << "> " << address << " set_swing_vertical=" << to_string((int)vertical) << endl;
-        }
-
-        void set_swing_horizontal(const std::string address, bool horizontal)
-        {
-            cout << "> " << address << " set_swing_horizontal=" << to_string((int)horizontal) << endl;
-        }
-
-        void set_custom_sensor(const std::string address, uint16_t message_number, float value)
-        {
-            last_custom_sensors.insert(message_number);
-        }
-
-        void assert_only_address(const std::string address)
-        {
-            assert(last_register_address == address);
-            assert(last_set_power_address == "");
-            assert(last_set_room_temperature_address == "");
-            assert(last_set_target_temperature_address == "");
-            assert(last_set_mode_address == "");
-            assert(last_set_fanmode_address == "");
-        }
-
-        void assert_values(const std::string address, bool power, float room_temp, float target_temp, Mode mode, FanMode fanmode)
-        {
-            assert(last_register_address == address);
-
-            assert(last_set_power_address == address);
-            assert(last_set_power_value == power);
-
-            assert(last_set_room_temperature_address == address);
-            assert(last_set_room_temperature_value == room_temp);
-
-            assert(last_set_target_temperature_address == address);
-            assert(last_set_target_temperature_value == target_temp);
-
-            assert(last_set_mode_address == address);
-            assert(last_set_mode_mode == mode);
-
-            assert(last_set_fanmode_address == address);
-            assert(last_set_fanmode_mode == fanmode);
-        }
-
-        void assert_values(const std::string address, bool power, float room_temp, float target_temp, Mode mode, FanMode fanmode, float humidity)
-        {
-            assert_values(address, power, room_temp, target_temp, mode, fanmode);
-
-            assert(last_set_room_humidity_address == address);
-            assert(last_set_room_humidity_value == humidity);
-        }
-    };
-
-    void test_process_data(const std::string &hex, DebugTarget &target)
-    {
-        cout << "test: " << hex << std::endl;
-        auto bytes = hex_to_bytes(hex);
-        assert(process_data(bytes, &target) == DataResult::Clear);
-    }
-
-    DebugTarget test_process_data(const std::string &hex)
-    {
-        DebugTarget target;
-        test_process_data(hex, target);
-        return target;
-    }
-
-    void assert_str(const std::string actual, const std::string expected)
-    {
-        if (actual != expected)
-        {
-            cout << "actual:   " << actual << std::endl;
-            cout << "expected: " << expected << std::endl;
-        }
-        assert(actual == expected);
-    }
-
-    namespace esphome
-    {
-        uint32_t millis()
-        {
-            return 0;
-        }
-        uint32_t micros()
-        {
-            return 0;
-        }
-        void delay(uint32_t ms) {}
-    } // namespace esphome
+        last_set_outdoor_temperature_value = value.to_float();
+    }
+
+    void set_indoor_eva_in_temperature(PackedAddress packed, Temperature value) override {}
+    void set_indoor_eva_out_temperature(PackedAddress packed, Temperature value) override {}
+
+    std::string last_set_target_water_temperature_address;
+    float last_set_target_water_temperature_value;
+    void set_target_water_temperature(PackedAddress packed, Temperature value) override
+    {
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_target_water_temperature=" << to_string(value.to_float()) << endl;
+        last_set_target_water_temperature_address = address;
+        last_set_target_water_temperature_value = value.to_float();
+    }
+
+    std::string last_set_mode_address;
+    Mode last_set_mode_mode;
+    void set_mode(PackedAddress packed, Mode mode) override
+    {
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_mode=" << to_string((int)mode) << endl;
+        last_set_mode_address = address;
+        last_set_mode_mode = mode;
+    }
+
+    void set_water_heater_mode(PackedAddress packed, WaterHeaterMode waterheatermode) override {}
+
+    std::string last_set_fanmode_address;
+    FanMode last_set_fanmode_mode;
+    void set_fanmode(PackedAddress packed, FanMode fanmode) override
+    {
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_fanmode=" << to_string((int)fanmode) << endl;
+        last_set_fanmode_address = address;
+        last_set_fanmode_mode = fanmode;
+    }
+
+    void set_altmode(PackedAddress packed, AltMode altmode) override
+    {
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_altmode=" << to_string((int)altmode) << endl;
+    }
+
+    void set_swing_vertical(PackedAddress packed, bool vertical) override
+    {
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_swing_vertical=" << to_string((int)vertical) << endl;
+    }
+
+    void set_swing_horizontal(PackedAddress packed, bool horizontal) override
+    {
+        const std::string address = unpack_address(packed);
+        cout << "> " << address << " set_swing_horizontal=" << to_string((int)horizontal) << endl;
+    }
+
+    std::set<uint16_t> last_custom_sensors;
+    void set_custom_sensor(PackedAddress packed, uint16_t message_number, long value) override
+    {
+        last_custom_sensors.insert(message_number);
+    }
+
+    void set_error_code(PackedAddress packed, int error_code) override {}
+    void set_outdoor_instantaneous_power(PackedAddress packed, float value) override {}
+    void set_outdoor_cumulative_energy(PackedAddress packed, float value) override {}
+    void set_outdoor_current(PackedAddress packed, float value) override {}
+    void set_outdoor_voltage(PackedAddress packed, float value) override {}
+
+    void assert_only_address(const std::string address)
+    {
+        assert(last_register_address == address);
+        assert(last_set_power_address == "");
+        assert(last_set_room_temperature_address == "");
+        assert(last_set_target_temperature_address == "");
+        assert(last_set_mode_address == "");
+        assert(last_set_fanmode_address == "");
+    }
+
+    void assert_values(const std::string address, bool power, float room_temp, float target_temp, Mode mode, FanMode fanmode)
+    {
+        assert(last_register_address == address);
+
+        assert(last_set_power_address == address);
+        assert(last_set_power_value == power);
+
+        assert(last_set_room_temperature_address == address);
+        assert(last_set_room_temperature_value == room_temp);
+
+        assert(last_set_target_temperature_address == address);
+        assert(last_set_target_temperature_value == target_temp);
+
+        assert(last_set_mode_address == address);
+        assert(last_set_mode_mode == mode);
+
+        assert(last_set_fanmode_address == address);
+        assert(last_set_fanmode_mode == fanmode);
+    }
+};
+
+void test_process_data(const std::string &hex, DebugTarget &target)
+{
+    cout << "test: " << hex << std::endl;
+    auto bytes = hex_to_bytes(hex);
+    assert(process_data(bytes, &target).type == DecodeResultType::Processed);
+}
+
+DebugTarget test_process_data(const std::string &hex)
+{
+    DebugTarget target;
+    test_process_data(hex, target);
+    return target;
+}
+
+void assert_str(const std::string actual, const std::string expected)
+{
+    if (actual != expected)
+    {
+        cout << "actual:   " << actual << std::endl;
+        cout << "expected: " << expected << std::endl;
+    }
+    assert(actual == expected);
+}
+
+namespace esphome
+{
+    uint32_t millis()
+    {
+        return 0;
+    }
+    uint32_t micros()
+    {
+        return 0;
+    }
+    void delay(uint32_t ms) {}
+} // namespace esphome
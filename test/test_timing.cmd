@@ -0,0 +1,3 @@
+@echo ""
+@echo ==== TESTING Timing ====
+@"%~dp0%build_and_run.cmd" test/main_test_timing.cpp
\ No newline at end of file
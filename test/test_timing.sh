@@ -0,0 +1,2 @@
+echo ==== TESTING Timing ====
+./test/build_and_run.sh test/main_test_timing.cpp
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include "esphome/core/hal.h"
+
+// Simulated time for host tests. The protocol code takes its time from
+// MessageTarget::get_miliseconds, which VirtualTarget answers from this clock, so hours of bus
+// time run in milliseconds and every timeout is hit exactly.
+class VirtualClock
+{
+public:
+    uint32_t now() const
+    {
+        return now_;
+    }
+
+    void set(uint32_t now)
+    {
+        now_ = now;
+    }
+
+    void advance(uint32_t ms)
+    {
+        now_ += ms;
+    }
+
+    // calls step() every tick ms until duration has passed
+    template <typename F>
+    void run(uint32_t duration, uint32_t tick, F step)
+    {
+        const uint32_t end = now_ + duration;
+        while (now_ < end)
+        {
+            advance(tick);
+            step();
+        }
+    }
+
+    static VirtualClock &instance()
+    {
+        static VirtualClock clock;
+        return clock;
+    }
+
+protected:
+    uint32_t now_ = 0;
+};
+
+// The hal is backed by the virtual clock as well (delay() is used by the NonNASA keepalive).
+// This header must be included by exactly one translation unit of a test program.
+namespace esphome
+{
+    uint32_t millis()
+    {
+        return VirtualClock::instance().now();
+    }
+
+    uint32_t micros()
+    {
+        return VirtualClock::instance().now() * 1000;
+    }
+
+    void delay(uint32_t ms)
+    {
+        VirtualClock::instance().advance(ms);
+    }
+} // namespace esphome
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include "virtual_clock.h"
+#include "../components/samsung_ac/device_registry.h"
+
+using namespace esphome::samsung_ac;
+
+// MessageTarget for host tests which runs on the virtual clock. Frames sent by the protocol are
+// recorded with their (virtual) time, received frames are passed to process_data like Samsung_AC does.
+class VirtualTarget : public MessageTarget
+{
+public:
+    struct SentFrame
+    {
+        uint32_t time;
+        std::vector<uint8_t> data;
+    };
+
+    explicit VirtualTarget(VirtualClock &clock = VirtualClock::instance()) : clock_(clock) {}
+
+    VirtualClock &clock()
+    {
+        return clock_;
+    }
+
+    // feeds bytes as if they arrived in one read, returns the number of frames the protocol
+    // processed. Bytes which can not be decoded are dropped right away.
+    size_t receive(const std::vector<uint8_t> &frame)
+    {
+        size_t processed = 0;
+        data_.insert(data_.end(), frame.begin(), frame.end());
+        while (!data_.empty())
+        {
+            auto result = process_data(data_, this);
+            if (result.type == DecodeResultType::Fill)
+                break;
+            if (result.type == DecodeResultType::Processed)
+                processed++;
+            data_.erase(data_.begin(), data_.begin() + std::min<size_t>(std::max<size_t>(result.bytes, 1), data_.size()));
+        }
+        return processed;
+    }
+
+    // NonNASA frames sent with the given command, from the given time on
+    size_t count_sent(uint8_t command, uint32_t since = 0) const
+    {
+        size_t count = 0;
+        for (const auto &frame : sent)
+        {
+            if (frame.time >= since && frame.data.size() > 3 && frame.data[3] == command)
+                count++;
+        }
+        return count;
+    }
+
+    std::vector<SentFrame> sent;
+    std::map<std::string, uint32_t> updates; // number of values published per (unpacked) address
+
+    uint32_t get_miliseconds() override
+    {
+        return clock_.now();
+    }
+
+    void publish_data(uint8_t id, std::vector<uint8_t> &&data) override
+    {
+        sent.push_back(SentFrame{clock_.now(), std::move(data)});
+    }
+
+    void ack_data(uint8_t id) override {}
+    void register_address(PackedAddress address) override {}
+
+    void set_power(PackedAddress address, bool value) override { updates[unpack_address(address)]++; }
+    void set_automatic_cleaning(PackedAddress address, bool value) override { updates[unpack_address(address)]++; }
+    void set_water_heater_power(PackedAddress address, bool value) override { updates[unpack_address(address)]++; }
+    void set_room_temperature(PackedAddress address, Temperature value) override { updates[unpack_address(address)]++; }
+    void set_target_temperature(PackedAddress address, Temperature value) override { updates[unpack_address(address)]++; }
+    void set_water_outlet_target(PackedAddress address, Temperature value) override { updates[unpack_address(address)]++; }
+    void set_outdoor_temperature(PackedAddress address, Temperature value) override { updates[unpack_address(address)]++; }
+    void set_indoor_eva_in_temperature(PackedAddress address, Temperature value) override { updates[unpack_address(address)]++; }
+    void set_indoor_eva_out_temperature(PackedAddress address, Temperature value) override { updates[unpack_address(address)]++; }
+    void set_target_water_temperature(PackedAddress address, Temperature value) override { updates[unpack_address(address)]++; }
+    void set_mode(PackedAddress address, Mode mode) override { updates[unpack_address(address)]++; }
+    void set_water_heater_mode(PackedAddress address, WaterHeaterMode waterheatermode) override { updates[unpack_address(address)]++; }
+    void set_fanmode(PackedAddress address, FanMode fanmode) override { updates[unpack_address(address)]++; }
+    void set_altmode(PackedAddress address, AltMode altmode) override { updates[unpack_address(address)]++; }
+    void set_swing_vertical(PackedAddress address, bool vertical) override { updates[unpack_address(address)]++; }
+    void set_swing_horizontal(PackedAddress address, bool horizontal) override { updates[unpack_address(address)]++; }
+    void set_custom_sensor(PackedAddress address, uint16_t message_number, long value) override { updates[unpack_address(address)]++; }
+    void set_error_code(PackedAddress address, int error_code) override { updates[unpack_address(address)]++; }
+    void set_outdoor_instantaneous_power(PackedAddress address, float value) override { updates[unpack_address(address)]++; }
+    void set_outdoor_cumulative_energy(PackedAddress address, float value) override { updates[unpack_address(address)]++; }
+    void set_outdoor_current(PackedAddress address, float value) override { updates[unpack_address(address)]++; }
+    void set_outdoor_voltage(PackedAddress address, float value) override { updates[unpack_address(address)]++; }
+
+protected:
+    VirtualClock &clock_;
+    std::vector<uint8_t> data_;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+// Runs task(i) for every i in [0, count) on all cores. Each worker starts with a contiguous range
+// of the tasks and takes them from the front, so neighbouring tasks finish at about the same
+// time. A worker which runs out steals from the back of another worker's queue.
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(unsigned threads = std::thread::hardware_concurrency())
+        : threads_(std::max(1u, threads))
+    {
+    }
+
+    unsigned threads() const
+    {
+        return threads_;
+    }
+
+    // blocks until all tasks are done
+    template <typename F>
+    void run(size_t count, F task)
+    {
+        std::vector<std::unique_ptr<Queue>> queues;
+        for (unsigned w = 0; w < threads_; w++)
+        {
+            queues.emplace_back(new Queue());
+            for (size_t i = count * w / threads_; i < count * (w + 1) / threads_; i++)
+                queues.back()->tasks.push_back(i);
+        }
+
+        std::vector<std::thread> workers;
+        for (unsigned w = 1; w < threads_; w++)
+            workers.emplace_back([&queues, &task, w]()
+                                 { work(queues, w, task); });
+        work(queues, 0, task);
+
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+protected:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    template <typename F>
+    static void work(std::vector<std::unique_ptr<Queue>> &queues, unsigned self, F &task)
+    {
+        size_t index;
+        while (pop(*queues[self], index) || steal(queues, self, index))
+            task(index);
+    }
+
+    static bool pop(Queue &queue, size_t &index)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        index = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    static bool steal(std::vector<std::unique_ptr<Queue>> &queues, unsigned self, size_t &index)
+    {
+        for (size_t i = 1; i < queues.size(); i++)
+        {
+            Queue &victim = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty())
+                continue;
+            index = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    unsigned threads_;
+};